@@ -29,8 +29,10 @@ int checkConfigOptions(const struct config_options * const __restrict__ co)
 {
   assert(co != NULL);
 
-  /* Warns about missed target. */
-  if (co->ip.daddr == INADDR_ANY)
+  /* Warns about missed target.
+     NOTE: 0.0.0.0 is fine as the start of a CIDR or a range (ex: 0.0.0.0/0).
+           Ranges and targets files leave 'bits' at 0. */
+  if (co->ip.daddr == INADDR_ANY && co->bits == CIDR_MAXIMUM)
   {
     ERROR("Need target address. Try --help for usage");
     return FALSE;
@@ -53,21 +55,117 @@ int checkConfigOptions(const struct config_options * const __restrict__ co)
     return FALSE;
   }
 
+  /* A mix selects its own protocols. */
+  if (co->mix_weights != NULL && co->ip.protocol != IPPROTO_T50)
+  {
+    ERROR("--mix and --protocol are not allowed together");
+    return FALSE;
+  }
+
+  /* The schedule is the one of the mix weights. */
+  if (co->mix_schedule && co->mix_weights == NULL)
+  {
+    ERROR("--mix-schedule needs --mix");
+    return FALSE;
+  }
+
+  /* AF_PACKET and AF_XDP send frames to an interface, not to a route. */
+  if ((co->output == OUTPUT_PACKET || co->output == OUTPUT_XDP) && co->interface == NULL)
+  {
+    ERROR("--output PACKET and XDP need --interface");
+    return FALSE;
+  }
+
+  if (co->output != OUTPUT_PACKET && co->output != OUTPUT_XDP && co->dst_mac_set)
+  {
+    ERROR("--dst-mac needs --output PACKET or XDP");
+    return FALSE;
+  }
+
+  if (co->output != OUTPUT_PACKET && co->qdisc_bypass)
+  {
+    ERROR("--qdisc-bypass needs --output PACKET");
+    return FALSE;
+  }
+
+  if (co->output != OUTPUT_PACKET && co->csum_offload)
+  {
+    ERROR("--csum-offload needs --output PACKET");
+    return FALSE;
+  }
+
+  /* The kernel would fix the bogus checksums. */
+  if (co->csum_offload && co->bogus_csum)
+  {
+    ERROR("--csum-offload and --bogus-csum can't be used together");
+    return FALSE;
+  }
+
+  if (co->output != OUTPUT_XDP && (co->queue_set || co->xdp_copy || co->busy_poll))
+  {
+    ERROR("--queue, --xdp-copy and --busy-poll need --output XDP");
+    return FALSE;
+  }
+
+  if (co->flow_churn > 0 && co->flows == 0)
+  {
+    ERROR("--flow-churn needs --flows");
+    return FALSE;
+  }
+
+  /* NOTE: Churn follows the clock, so it can't be replayed. */
+  if (co->flow_churn > 0 && co->seed_set)
+  {
+    ERROR("--flow-churn and --seed can't be used together");
+    return FALSE;
+  }
+
+  if (co->output != OUTPUT_URING && co->sqpoll)
+  {
+    ERROR("--sqpoll needs --output URING");
+    return FALSE;
+  }
+
+  if ((co->output == OUTPUT_PCAP || co->output == OUTPUT_PCAPNG) != (co->write_file != NULL))
+  {
+    ERROR("--output PCAP and PCAPNG need --write (and --write needs them)");
+    return FALSE;
+  }
+
+  if (co->file_per_worker && co->write_file == NULL)
+  {
+    ERROR("--file-per-worker needs --write");
+    return FALSE;
+  }
+
+#ifdef __HAVE_RDRAND__
+  /* RDRAND can't be seeded. */
+  if (co->seed_set)
+  {
+    ERROR("--seed is not available on RDRAND builds");
+    return FALSE;
+  }
+#endif
+
   if (!checkThreshold(co))
     return FALSE;
 
-  if (!co->flood)
+  if (co->batch < 1 || co->batch > MAXIMUM_BATCH)
   {
+    fprintf(stderr, "%s: batch size must be between 1 and %d\n", PACKAGE, MAXIMUM_BATCH);
+    return FALSE;
+  }
+
 #ifdef  __HAVE_TURBO__
-    /* Sanitizing TURBO mode. */
-    if (co->turbo)
-    {
-      ERROR("turbo mode is only available in flood mode");
-      return FALSE;
-    }
-#endif  /* __HAVE_TURBO__ */
+  /* Sanitizing the number of workers. */
+  if (co->workers < 1 || co->workers > MAXIMUM_WORKERS)
+  {
+    fprintf(stderr, "%s: number of workers must be between 1 and %d\n", PACKAGE, MAXIMUM_WORKERS);
+    return FALSE;
   }
-  else /* if (co->flood) isn't 0 */
+#endif  /* __HAVE_TURBO__ */
+
+  if (co->flood)
   {
     /* Warning FLOOD mode. */
     puts("Entering in flood mode...");
@@ -77,8 +175,8 @@ int checkConfigOptions(const struct config_options * const __restrict__ co)
       puts("Activating turbo...");
 #endif  /* __HAVE_TURBO__ */
 
-    /* Warning CIDR mode. */
-    if (co->bits != 0)
+    /* Warning CIDR mode (more than one target). */
+    if (co->bits < CIDR_MAXIMUM)
       puts("Performing DDoS...");
 
     puts("Hit CTRL+C to break.");
@@ -90,7 +188,8 @@ int checkConfigOptions(const struct config_options * const __restrict__ co)
 
 static int checkThreshold(const struct config_options * const __restrict__ co)
 {
-  if (co->ip.protocol == IPPROTO_T50)
+  /* NOTE: A weighted mix doesn't send every protocol in turn. */
+  if (co->ip.protocol == IPPROTO_T50 && co->mix_weights == NULL)
   {
     threshold_t minThreshold = (threshold_t)getNumberOfRegisteredModules();
 
@@ -19,11 +19,70 @@
 
 #include <common.h>
 
-static struct cidr cidr = { 0, 0 };
+static struct cidr cidr;
 
-/* CIDR configuration tiny C algorithm */
-struct cidr *config_cidr(uint32_t bits, in_addr_t address)
+static uint32_t permute(const struct cidr *, uint32_t);
+
+/* Address (host order) of the host number 'n'. 'hint' is its range on a
+   targets file, as on targets_seek(). */
+static inline in_addr_t host(const struct cidr *c, uint32_t n, uint32_t *hint)
+{
+  if (c->targets != NULL)
+  {
+    const struct target_range *r = targets_seek(c->targets, n, hint);
+
+    return r->first + (n - r->start);
+  }
+
+  return c->__1st_addr + n;
+}
+
+/* Address (host order) on place 's'. FALSE if it is padding (targets
+   file only: a CIDR has a place per host). */
+static inline int place(const struct cidr *c, uint32_t s, in_addr_t *addr)
 {
+  if (c->targets != NULL)
+    return targets_slot(c->targets, s, addr);
+
+  *addr = c->__1st_addr + s;
+  return TRUE;
+}
+
+/* Place of the host number 'n' ('hint' as above). */
+static inline uint32_t slot(const struct cidr *c, uint32_t n, uint32_t *hint)
+{
+  if (c->targets != NULL)
+  {
+    const struct target_range *r = targets_seek(c->targets, n, hint);
+
+    return r->slot + (n - r->start);
+  }
+
+  return n;
+}
+
+/* Next host of the permutation: on a targets file, the places of padding
+   are passed over by going on along the cycle. Still one to one, since
+   it starts on a host. */
+static inline in_addr_t permuted(const struct cidr *c, uint32_t s)
+{
+  in_addr_t addr;
+
+  do
+    s = permute(c, s);
+  while (!place(c, s, &addr));
+
+  return addr;
+}
+
+/* CIDR configuration tiny C algorithm. A start-end target ('last' is not
+   INADDR_ANY) has every address from 'address' to 'last'. With a targets
+   file, its hosts take the place of the CIDR ones ('bits', 'address' and
+   'last' are not used). */
+struct cidr *config_cidr(uint32_t bits, in_addr_t address, in_addr_t last, const struct targets *targets)
+{
+  int i;
+
   /* FIX: Don't need to validate bits. It is already done in getIpAndCidrFromString() function @ config.c */
 
   /*
@@ -52,26 +111,40 @@ struct cidr *config_cidr(uint32_t bits, in_addr_t address)
    *     address and 'Network Mask' adding one  gives the first IP address
    *     for the CIDR.
    */
-  if (bits < CIDR_MAXIMUM)
+  cidr.targets = targets;
+  if (targets != NULL)
+  {
+    cidr.hostid = targets->total;
+    cidr.slots = targets->slots;
+    cidr.__1st_addr = 0;
+  }
+  else if (last != INADDR_ANY)
+  {
+    /* NOTE: getRangeFromString() @ config.c makes sure it fits. */
+    cidr.hostid = ntohl(last) - ntohl(address) + 1;
+    cidr.__1st_addr = ntohl(address);
+  }
+  else if (bits < CIDR_MAXIMUM)
   {
+    /* NOTE: 64 bits, since 1 << 32 (/0) doesn't fit. */
+    uint64_t hosts = (1ULL << (32 - bits)) - 2;
     uint32_t netmask;
 
-    cidr.hostid = (1U << (32 - bits)) - 2U;
-
     /* XXX Sanitizing the maximum host identifier's IP addresses.
      * XXX Should never reaches here!!! */
-    if (cidr.hostid > MAXIMUM_IP_ADDRESSES)
+    if (hosts > MAXIMUM_IP_ADDRESSES)
     {
       char errstr[144];
 
       sprintf(errstr, "internal error detecded -- please, report.\n"
-                      "cidr.hostid (%u) > MAXIMUM_IP_ADDRESSES (%u): Probably a specific platform error",
-                      cidr.hostid, MAXIMUM_IP_ADDRESSES);
+                      "cidr.hostid (%" PRIu64 ") > MAXIMUM_IP_ADDRESSES (%u): Probably a specific platform error",
+                      hosts, MAXIMUM_IP_ADDRESSES);
       ERROR(errstr);
 
       return NULL;
     }
 
+    cidr.hostid = hosts;
     netmask = ~(0xffffffffU >> bits);
     cidr.__1st_addr = (ntohl(address) & netmask) + 1;
   }
@@ -81,5 +154,82 @@ struct cidr *config_cidr(uint32_t bits, in_addr_t address)
     cidr.__1st_addr = ntohl(address);
   }
 
+  if (targets == NULL)
+    cidr.slots = cidr.hostid;
+
+  /* Permutation of the places (--dest-mode PERMUTE): a Feistel network
+     over the smallest even number of bits holding all of them. */
+  for (cidr.half_bits = 1; cidr.slots > 1ULL << (2 * cidr.half_bits); cidr.half_bits++);
+  for (i = 0; i < CIDR_ROUNDS; i++)
+    cidr.keys[i] = RANDOM();
+
   return &cidr;
 }
+
+/* Destination of the next packet (host byte order). 'pos' is the worker
+   place on the hosts, moved 'step' (the number of workers) ahead on each
+   call: the workers share one cycle without repeating hosts. 'hint' is
+   the targets file range of 'pos'. */
+in_addr_t cidr_address(const struct cidr *c, unsigned mode, uint64_t *pos, uint32_t *hint, unsigned step)
+{
+  uint32_t n;
+
+  /* NOTE: The previous code did not account for 'hostid == 0'! */
+  if (c->hostid == 0)
+    return c->__1st_addr;
+
+  if (mode == DEST_RANDOM)
+    return c->targets != NULL ? targets_random(c->targets) :
+                                c->__1st_addr + random_range(c->hostid);
+
+  n = *pos;
+  if ((*pos += step) >= c->hostid)
+    *pos %= c->hostid;
+
+  if (mode == DEST_PERMUTE)
+    return permuted(c, slot(c, n, hint));
+
+  return host(c, n, hint);
+}
+
+/* Destination of flow 'id' (--flows): the host at that place on the
+   --dest-mode order (hashed for RANDOM, which has none). */
+in_addr_t cidr_flow_address(const struct cidr *c, unsigned mode, uint64_t id)
+{
+  uint32_t hint = 0;
+
+  if (c->hostid == 0)
+    return c->__1st_addr;
+
+  switch (mode)
+  {
+    case DEST_RANDOM:     return host(c, random_scale(random_hash32(id ^ id >> 32, c->keys[0]), c->hostid), &hint);
+    case DEST_SEQUENTIAL: return host(c, id % c->hostid, &hint);
+    default:              return permuted(c, slot(c, id % c->hostid, &hint));
+  }
+}
+
+/* Maps a place to another, one to one. The network works on
+   2 * half_bits, up to 4 times the places: results past the last place go
+   through it again (cycle walking) until they fall in. */
+static uint32_t permute(const struct cidr *c, uint32_t x)
+{
+  uint32_t mask = (1U << c->half_bits) - 1;
+
+  do
+  {
+    uint32_t l = x >> c->half_bits, r = x & mask, t;
+    int i;
+
+    for (i = 0; i < CIDR_ROUNDS; i++)
+    {
+      t = l ^ (random_hash32(r, c->keys[i]) & mask);
+      l = r;
+      r = t;
+    }
+
+    x = (l << c->half_bits) | r;
+  } while (x >= c->slots);
+
+  return x;
+}
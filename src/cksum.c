@@ -19,87 +19,209 @@
 
 #include <common.h>
 
-/* Calculates checksum */
-/* This function is 5 times faster than the "official" rfc 1071 implementation (and shortter too!). */
-
-/* FIXME: Maybe there is a bug here still... Must check. */
-/* NOTE: This version of cksum is retired, for now, due to bugs. */
-//uint16_t cksum(void *data, size_t length)
-//{
-//  uint64_t sum, oldsum, *p = data;
-//  uint32_t t1, t2;
-//  uint16_t t3, t4;
-//
-//  sum = oldsum = 0;
-//
-//  /* Sums 8 bytes at a time... */
-//  while (length >= sizeof(uint64_t))
-//  {
-//    sum += *p++;
-//    if (sum < oldsum) sum++;
-//    oldsum = sum;
-//    length -= sizeof(uint64_t);
-//  }
-//
-//  /* Sums the remaing data, if any */
-//  data = p;
-//  if (length >= sizeof(uint32_t))
-//  {
-//    sum += *(uint32_t *)data;
-//    if (sum < oldsum) sum++;
-//    oldsum = sum;
-//    length -= sizeof(uint32_t);
-//    data += sizeof(uint32_t);
-//  }
-//
-//  if (length >= sizeof(uint16_t))
-//  {
-//    sum += *(uint16_t *)data;
-//    if (sum < oldsum) sum++;
-//    oldsum = sum;
-//    length -= sizeof(uint16_t);
-//    data += sizeof(uint16_t);
-//  }
-//
-//  if (length)
-//  {
-//    sum += *(uint8_t *)data;
-//    if (sum < oldsum) sum++;
-//  }
-//
-//  /* Fold down to 16 bits */
-//  t1 = sum;
-//  t2 = sum >> 32;
-//  t1 += t2;
-//  if (t1 < t2) t1++;
-//
-//  t3 = t1;
-//  t4 = t1 >> 16;
-//  t3 += t4;
-//  if (t3 < t4) t3++;
-//
-//  return ~t3;
-//}
-
-/* This is the old version, implemented on RFC 1071. */
-uint16_t cksum(void *data, size_t length)
+/* Internet checksum (RFC 1071).
+
+   The one's complement sum doesn't depend on the word size: 32 bit words
+   summed on 64 bit accumulators, then folded, give the same result as 16
+   bit words with end around carry (2^16 = 1, mod 2^16 - 1). It doesn't
+   depend on byte order either, as long as the result is stored as read.
+   So the sum is done 4 bytes at a time, on 64 bit lanes that never carry
+   out, by the widest implementation the CPU has. cksum_init() picks it
+   at startup (cpuid); until then the scalar one is used. */
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+static uint64_t cksum_add_scalar(const void *, size_t, uint64_t);
+
+static uint64_t (*cksum_add_impl)(const void *, size_t, uint64_t) = cksum_add_scalar;
+
+/* Scalar: two 32 bit words per 64 bit load. Also does the tails of the
+   SIMD versions. */
+static uint64_t cksum_add_scalar(const void *data, size_t length, uint64_t sum)
 {
-  uint32_t sum;
-  uint16_t *p = data;
+  const uint8_t *p = data;
+  uint64_t sum2 = 0, w;
+  uint32_t d;
+  uint16_t h;
+
+  for (; length >= 16; length -= 16, p += 16)
+  {
+    memcpy(&w, p, 8);
+    sum += (uint32_t)w;
+    sum2 += w >> 32;
+    memcpy(&w, p + 8, 8);
+    sum += (uint32_t)w;
+    sum2 += w >> 32;
+  }
 
-  sum = 0;
+  for (; length >= 4; length -= 4, p += 4)
+  {
+    memcpy(&d, p, 4);
+    sum += d;
+  }
 
-  while (length > 1)
+  if (length >= 2)
   {
-    sum += *p++;
+    memcpy(&h, p, 2);
+    sum += h;
+    p += 2;
     length -= 2;
   }
 
+  /* NOTE: The odd byte is padded with a zero byte after it. */
   if (length)
-    sum += *(unsigned char *)p;
+  {
+    h = 0;
+    memcpy(&h, p, 1);
+    sum += h;
+  }
+
+  return sum + sum2;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/* SSE2: 32 bytes per step. Each 64 bit lane is split in its two 32 bit
+   words with a mask and a shift (no shuffles). */
+__attribute__((target("sse2")))
+static uint64_t cksum_add_sse2(const void *data, size_t length, uint64_t sum)
+{
+  const uint8_t *p = data;
+  __m128i mask = _mm_set1_epi64x(0xffffffffULL);
+  __m128i acc1 = _mm_setzero_si128(), acc2 = acc1, acc3 = acc1, acc4 = acc1, v, w;
+  uint64_t lanes[2];
+
+  for (; length >= 32; length -= 32, p += 32)
+  {
+    v = _mm_loadu_si128((const __m128i *)p);
+    w = _mm_loadu_si128((const __m128i *)(p + 16));
+    acc1 = _mm_add_epi64(acc1, _mm_and_si128(v, mask));
+    acc2 = _mm_add_epi64(acc2, _mm_srli_epi64(v, 32));
+    acc3 = _mm_add_epi64(acc3, _mm_and_si128(w, mask));
+    acc4 = _mm_add_epi64(acc4, _mm_srli_epi64(w, 32));
+  }
+
+  acc1 = _mm_add_epi64(_mm_add_epi64(acc1, acc2), _mm_add_epi64(acc3, acc4));
+  _mm_storeu_si128((__m128i *)lanes, acc1);
+
+  return cksum_add_scalar(p, length, sum + lanes[0] + lanes[1]);
+}
+
+/* AVX2: 64 bytes per step, as above. */
+__attribute__((target("avx2")))
+static uint64_t cksum_add_avx2(const void *data, size_t length, uint64_t sum)
+{
+  const uint8_t *p = data;
+  __m256i mask = _mm256_set1_epi64x(0xffffffffULL);
+  __m256i acc1 = _mm256_setzero_si256(), acc2 = acc1, acc3 = acc1, acc4 = acc1, v, w;
+  uint64_t lanes[4];
+
+  for (; length >= 64; length -= 64, p += 64)
+  {
+    v = _mm256_loadu_si256((const __m256i *)p);
+    w = _mm256_loadu_si256((const __m256i *)(p + 32));
+    acc1 = _mm256_add_epi64(acc1, _mm256_and_si256(v, mask));
+    acc2 = _mm256_add_epi64(acc2, _mm256_srli_epi64(v, 32));
+    acc3 = _mm256_add_epi64(acc3, _mm256_and_si256(w, mask));
+    acc4 = _mm256_add_epi64(acc4, _mm256_srli_epi64(w, 32));
+  }
+
+  if (length >= 32)
+  {
+    v = _mm256_loadu_si256((const __m256i *)p);
+    acc1 = _mm256_add_epi64(acc1, _mm256_and_si256(v, mask));
+    acc2 = _mm256_add_epi64(acc2, _mm256_srli_epi64(v, 32));
+    p += 32;
+    length -= 32;
+  }
 
-  while (sum >> 16)
-    sum = (sum & 0xffff) + (sum >> 16);
+  acc1 = _mm256_add_epi64(_mm256_add_epi64(acc1, acc2), _mm256_add_epi64(acc3, acc4));
+  _mm256_storeu_si256((__m256i *)lanes, acc1);
+
+  return cksum_add_scalar(p, length, sum + lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+#endif
+
+/* Below this size the vector setup and the indirect call cost more than
+   they save (most headers). */
+#define CKSUM_SIMD_MIN 128
+
+/* Selects the implementation, once, before the workers start. */
+void cksum_init(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2"))
+    cksum_add_impl = cksum_add_avx2;
+  else if (__builtin_cpu_supports("sse2"))
+    cksum_add_impl = cksum_add_sse2;
+#endif
+}
+
+/* Adds 'length' bytes to a partial sum. Every piece but the last must have
+   an even length (a piece starting at an odd offset would be summed with
+   its bytes swapped). */
+uint64_t cksum_add(const void *data, size_t length, uint64_t sum)
+{
+  if (length < CKSUM_SIMD_MIN)
+    return cksum_add_scalar(data, length, sum);
+
+  return cksum_add_impl(data, length, sum);
+}
+
+/* Updates a checksum when some of its words change (RFC 1624, eqn. 3):
+   HC' = ~(~HC + ~m + m'), 'old_sum' and 'new_sum' being the partial sums
+   of the words before (m) and after (m') the change. A field at an odd
+   offset is summed with the whole words holding it. Only all zero data
+   gives 0x0000 where cksum() gives 0xffff (the same one's complement). */
+uint16_t cksum_update(uint16_t check, uint64_t old_sum, uint64_t new_sum)
+{
+  uint64_t sum = (uint16_t)~check;
+
+  sum += cksum_fold(old_sum);
+  sum += (uint16_t)~cksum_fold(new_sum);
+
+  return cksum_fold(sum);
+}
+
+/* Fills the IP header checksum of a datagram of 'len' bytes, if the header
+   fits. The raw socket (SOCK_RAW) has the kernel do it; the backends
+   writing frames or captures call this instead. */
+void ip_fill_checksum(void *data, size_t len)
+{
+  struct iphdr *ip = data;
+
+  if (len >= sizeof(struct iphdr) && ip->ihl * 4U <= len)
+  {
+    ip->check = 0;
+    ip->check = cksum(ip, ip->ihl * 4);
+  }
+}
+
+/* Partial sum of the pseudo header (RFC 768, RFC 793), added to the sum of
+   a UDP, TCP or DCCP segment of 'len' bytes. It isn't sent: only summed. */
+uint64_t cksum_pseudo(in_addr_t saddr, in_addr_t daddr, uint8_t protocol, uint16_t len)
+{
+  return (uint64_t)(saddr & 0xffff) + (saddr >> 16) +
+         (daddr & 0xffff) + (daddr >> 16) +
+         htons(protocol) + htons(len);
+}
+
+/* Folds a partial sum to 16 bits and complements it. */
+uint16_t cksum_fold(uint64_t sum)
+{
+  sum = (sum & 0xffffffffULL) + (sum >> 32);
+  sum = (sum & 0xffffffffULL) + (sum >> 32);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
 
   return ~sum;
 }
+
+uint16_t cksum(void *data, size_t length)
+{
+  return cksum_fold(cksum_add(data, length, 0));
+}
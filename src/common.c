@@ -19,9 +19,10 @@
 
 #include <common.h>
 
-/* Actual packet buffer. Allocated dynamically. */
-void *packet = NULL;
-size_t current_packet_size = 0;
+/* Actual packet buffer. Allocated dynamically.
+   NOTE: Each worker thread has its own buffer. */
+__thread void *packet = NULL;
+__thread size_t current_packet_size = 0;
 
 /* "private" variable holding the number of modules. Use getNumberOfRegisteredModules() funcion to get it. */
 static size_t numOfModules = 0;
@@ -34,7 +35,7 @@ uint32_t NETMASK_RND(uint32_t foo)
   if (foo != INADDR_ANY)
     t = foo;
   else
-    t = ~(0xffffffffU >> (8 + (RANDOM() % 23)));
+    t = ~(0xffffffffU >> (8 + random_range(23)));
 
   return htonl(t);
 }
@@ -64,6 +65,14 @@ void alloc_packet(size_t new_packet_size)
   }
 }
 
+/* Frees the packet buffer of the calling thread. */
+void free_packet(void)
+{
+  free(packet);
+  packet = NULL;
+  current_packet_size = 0;
+}
+
 /* Scan the list of modules (ONCE!), returning the number of itens in the list. */
 /* Function prototype moved to modules.h. */
 /* NOTE: This function is here to not polute modules.c, where we keep only the modules definitions. */
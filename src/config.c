@@ -29,6 +29,11 @@
 static struct config_options co = {
   /* XXX COMMON OPTIONS                                                         */
   .threshold = 1000,                  /* default threshold                      */
+  .batch = 1,                         /* default packets per send syscall       */
+#ifdef  __HAVE_TURBO__
+  .workers = 1,                       /* default number of worker threads       */
+#endif  /* __HAVE_TURBO__ */
+  .port_mode = DEST_SEQUENTIAL,       /* default port lists order (round robin) */
 
   /* XXX IP HEADER OPTIONS  (IPPROTO_IP = 0)                                    */
   .ip = {
@@ -126,7 +131,36 @@ static const struct option long_opt[] = {
   { "bogus-csum",             no_argument,       NULL, 'B'                           },
 #ifdef  __HAVE_TURBO__
   { "turbo",                  no_argument,       NULL, OPTION_TURBO                  },
+  { "workers",                required_argument, NULL, OPTION_WORKERS                },
 #endif  /* __HAVE_TURBO__ */
+  { "batch",                  required_argument, NULL, OPTION_BATCH                  },
+  { "cpus",                   required_argument, NULL, OPTION_CPUS                   },
+  { "pps",                    required_argument, NULL, OPTION_PPS                    },
+  { "bps",                    required_argument, NULL, OPTION_BPS                    },
+  { "overhead",               required_argument, NULL, OPTION_OVERHEAD               },
+  { "stats-interval",         required_argument, NULL, OPTION_STATS_INTERVAL         },
+  { "report",                 required_argument, NULL, OPTION_REPORT                 },
+  { "mix",                    required_argument, NULL, OPTION_MIX                    },
+  { "mix-schedule",           no_argument,       NULL, OPTION_MIX_SCHEDULE           },
+  { "no-template",            no_argument,       NULL, OPTION_NO_TEMPLATE            },
+  { "output",                 required_argument, NULL, OPTION_OUTPUT                 },
+  { "interface",              required_argument, NULL, OPTION_INTERFACE              },
+  { "dst-mac",                required_argument, NULL, OPTION_DST_MAC                },
+  { "qdisc-bypass",           no_argument,       NULL, OPTION_QDISC_BYPASS           },
+  { "csum-offload",           no_argument,       NULL, OPTION_CSUM_OFFLOAD           },
+  { "queue",                  required_argument, NULL, OPTION_QUEUE                  },
+  { "xdp-copy",               no_argument,       NULL, OPTION_XDP_COPY               },
+  { "busy-poll",              no_argument,       NULL, OPTION_BUSY_POLL              },
+  { "sqpoll",                 no_argument,       NULL, OPTION_SQPOLL                 },
+  { "write",                  required_argument, NULL, OPTION_WRITE                  },
+  { "file-per-worker",        no_argument,       NULL, OPTION_FILE_PER_WORKER        },
+  { "seed",                   required_argument, NULL, OPTION_SEED                   },
+  { "dest-mode",              required_argument, NULL, OPTION_DEST_MODE              },
+  { "targets-file",           required_argument, NULL, OPTION_TARGETS_FILE           },
+  { "flows",                  required_argument, NULL, OPTION_FLOWS                  },
+  { "flow-mode",              required_argument, NULL, OPTION_FLOW_MODE              },
+  { "flow-churn",             required_argument, NULL, OPTION_FLOW_CHURN             },
+  { "port-mode",              required_argument, NULL, OPTION_PORT_MODE              },
   { "version",                no_argument,       NULL, 'v'                           },
   { "help",                   no_argument,       NULL, 'h'                           },
 
@@ -387,7 +421,12 @@ static char **getTokensList(void);
 static void listProtocols(void);
 static void setDefaultModuleOption(void);
 static int  getIpAndCidrFromString(char const * const, T50_tmp_addr_t *);
+static int  getRangeFromString(const char *, in_addr_t *, in_addr_t *);
 static void CheckRangeFromBits(const char *, int, int);
+static double getRateFromString(const char *, const char *);
+static uint32_t getCountFromString(const char *, const char *);
+static uint64_t getSeedFromString(const char *);
+static void getPortsFromString(const char *, const char *, uint16_t *, uint16_t **, unsigned *);
 
 /* CLI options configuration */
 struct config_options *getConfigOptions(int argc, char **argv)
@@ -415,9 +454,131 @@ struct config_options *getConfigOptions(int argc, char **argv)
       case OPTION_FLOOD:        co.flood        = TRUE; break;
       case OPTION_ENCAPSULATED: co.encapsulated = TRUE; break;
       case 'B':                 co.bogus_csum   = TRUE; break;
+      case OPTION_BATCH:        co.batch        = atoi(optarg); break;
+      case OPTION_CPUS:
+        free(co.cpu_list);
+        if (!parseCpuList(optarg, &co.cpu_list, &co.num_cpus))
+        {
+          fprintf(stderr, "%s: invalid cpu list '%s' (ex: 2-9,12)\n", PACKAGE, optarg);
+          exit(EXIT_FAILURE);
+        }
+        break;
+      case OPTION_PPS:          co.pps          = getRateFromString("--pps", optarg); break;
+      case OPTION_BPS:          co.bps          = getRateFromString("--bps", optarg); break;
+      case OPTION_OVERHEAD:
+        if (strcasecmp(optarg, "NONE") == 0)
+          co.overhead = OVERHEAD_NONE;
+        else if (strcasecmp(optarg, "L2") == 0)
+          co.overhead = OVERHEAD_L2;
+        else if (strcasecmp(optarg, "L1") == 0)
+          co.overhead = OVERHEAD_L1;
+        else
+        {
+          ERROR("--overhead must be NONE, L2 or L1");
+          exit(EXIT_FAILURE);
+        }
+        break;
+      case OPTION_STATS_INTERVAL:
+        co.stats_interval = strtod(optarg, &tmp_ptr);
+        if (*tmp_ptr != '\0' || tmp_ptr == optarg || co.stats_interval <= 0)
+        {
+          ERROR("--stats-interval must be a positive number of seconds");
+          exit(EXIT_FAILURE);
+        }
+        break;
+      case OPTION_REPORT:       co.report_file  = optarg; break;
+      case OPTION_MIX:
+        if (!parseMix(optarg, &co.mix_weights))
+        {
+          fprintf(stderr, "%s: invalid protocol mix '%s' (ex: TCP:60,UDP:30,ICMP:10)\n", PACKAGE, optarg);
+          exit(EXIT_FAILURE);
+        }
+
+        /* A mix is a weighted T50 protocol. */
+        co.mix = optarg;
+        co.ip.protocol = IPPROTO_T50;
+        co.ip.protoname = getNumberOfRegisteredModules();
+        break;
+      case OPTION_MIX_SCHEDULE: co.mix_schedule = TRUE; break;
+      case OPTION_NO_TEMPLATE: co.no_template = TRUE; break;
+      case OPTION_OUTPUT:
+        if ((tmp = getOutputType(optarg)) < 0)
+        {
+          ERROR("--output must be RAW, PACKET, XDP, URING, PCAP, PCAPNG or NULL");
+          exit(EXIT_FAILURE);
+        }
+        co.output = tmp;
+        break;
+      case OPTION_INTERFACE: co.interface = optarg; break;
+      case OPTION_DST_MAC:
+        {
+          uint8_t *m = co.dst_mac;
+          char c;
+
+          if (sscanf(optarg, "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx%c",
+                     &m[0], &m[1], &m[2], &m[3], &m[4], &m[5], &c) != 6)
+          {
+            ERROR("--dst-mac must be like 00:11:22:33:44:55");
+            exit(EXIT_FAILURE);
+          }
+          co.dst_mac_set = TRUE;
+        }
+        break;
+      case OPTION_QDISC_BYPASS: co.qdisc_bypass = TRUE; break;
+      case OPTION_CSUM_OFFLOAD: co.csum_offload = TRUE; break;
+      case OPTION_QUEUE:        co.queue = atoi(optarg); co.queue_set = TRUE; break;
+      case OPTION_XDP_COPY:     co.xdp_copy = TRUE; break;
+      case OPTION_BUSY_POLL:    co.busy_poll = TRUE; break;
+      case OPTION_SQPOLL:       co.sqpoll = TRUE; break;
+      case OPTION_WRITE:        co.write_file = optarg; break;
+      case OPTION_FILE_PER_WORKER: co.file_per_worker = TRUE; break;
+      case OPTION_SEED:         co.seed = getSeedFromString(optarg); co.seed_set = TRUE; break;
+      case OPTION_DEST_MODE:
+        if (strcasecmp(optarg, "RANDOM") == 0)
+          co.dest_mode = DEST_RANDOM;
+        else if (strcasecmp(optarg, "SEQUENTIAL") == 0)
+          co.dest_mode = DEST_SEQUENTIAL;
+        else if (strcasecmp(optarg, "PERMUTE") == 0)
+          co.dest_mode = DEST_PERMUTE;
+        else
+        {
+          ERROR("--dest-mode must be RANDOM, SEQUENTIAL or PERMUTE");
+          exit(EXIT_FAILURE);
+        }
+        break;
+      case OPTION_TARGETS_FILE: co.targets_file = optarg; break;
+      case OPTION_FLOWS:        co.flows = getCountFromString("--flows", optarg); break;
+      case OPTION_FLOW_MODE:
+        if (strcasecmp(optarg, "SEQUENTIAL") == 0)
+          co.flow_mode = FLOW_SEQUENTIAL;
+        else if (strcasecmp(optarg, "RANDOM") == 0)
+          co.flow_mode = FLOW_RANDOM;
+        else if (strcasecmp(optarg, "ZIPF") == 0)
+          co.flow_mode = FLOW_ZIPF;
+        else
+        {
+          ERROR("--flow-mode must be SEQUENTIAL, RANDOM or ZIPF");
+          exit(EXIT_FAILURE);
+        }
+        break;
+      case OPTION_FLOW_CHURN:   co.flow_churn = getRateFromString("--flow-churn", optarg); break;
+      case OPTION_PORT_MODE:
+        if (strcasecmp(optarg, "SEQUENTIAL") == 0)
+          co.port_mode = DEST_SEQUENTIAL;
+        else if (strcasecmp(optarg, "RANDOM") == 0)
+          co.port_mode = DEST_RANDOM;
+        else if (strcasecmp(optarg, "PERMUTE") == 0)
+          co.port_mode = DEST_PERMUTE;
+        else
+        {
+          ERROR("--port-mode must be SEQUENTIAL, RANDOM or PERMUTE");
+          exit(EXIT_FAILURE);
+        }
+        break;
 
 #ifdef  __HAVE_TURBO__
       case OPTION_TURBO:        co.turbo        = TRUE; break;
+      case OPTION_WORKERS:      co.workers      = atoi(optarg); break;
 #endif  /* __HAVE_TURBO__ */
 
       case OPTION_LIST_PROTOCOL:
@@ -438,8 +599,12 @@ struct config_options *getConfigOptions(int argc, char **argv)
       case OPTION_GRE_DADDR:            co.gre.daddr    = resolv(optarg); break;
 
       /* XXX DCCP, TCP & UDP HEADER OPTIONS */
-      case OPTION_SOURCE:       CheckRangeFromBits("--sport", 16, tmp = atoi(optarg)); co.source = tmp; break;
-      case OPTION_DESTINATION:  CheckRangeFromBits("--dport", 16, tmp = atoi(optarg)); co.dest = tmp; break;
+      case OPTION_SOURCE:
+        getPortsFromString("--sport", optarg, &co.source, &co.sport_list, &co.num_sports);
+        break;
+      case OPTION_DESTINATION:
+        getPortsFromString("--dport", optarg, &co.dest, &co.dport_list, &co.num_dports);
+        break;
 
       /* XXX IP HEADER OPTIONS  (IPPROTO_IP = 0) */
       case OPTION_IP_TOS:       CheckRangeFromBits("--tos", 8, tmp = atoi(optarg)); co.ip.tos = tmp; break;
@@ -802,6 +967,19 @@ struct config_options *getConfigOptions(int argc, char **argv)
     }
   }
 
+  /* The targets file replaces the target. Its addresses are loaded later,
+     by main(). */
+  if (co.targets_file != NULL)
+  {
+    if (optind < argc)
+    {
+      ERROR("--targets-file and a target address are not allowed together");
+      return NULL;
+    }
+
+    return &co;
+  }
+
   /* Checking the command line interface options. */
   if (optind >= argc)
   {
@@ -809,8 +987,10 @@ struct config_options *getConfigOptions(int argc, char **argv)
     return NULL;
   }
 
-  /* Get host and cidr. */
-  if (getIpAndCidrFromString(argv[optind], &addr))
+  /* Get host and cidr (or a start-end range). */
+  if (getRangeFromString(argv[optind], &co.ip.daddr, &co.range_end))
+    co.bits = 0;
+  else if (getIpAndCidrFromString(argv[optind], &addr))
   {
     /* If ok, then set values directly to "options" structure. */
     co.bits = addr.cidr;
@@ -960,14 +1140,7 @@ static int getIpAndCidrFromString(char const * const addr, T50_tmp_addr_t *addr_
   {
     len = MATCH_LENGTH(rm[5]) - 1;
     COPY_SUBSTRING(t, addr + rm[5].rm_so + 1, len);
-
-    if ((matches[4] = atoi(t)) == 0)
-    {
-      /* if cidr is actually '0', then it is an error! */
-      free(t);
-      regfree(&re);
-      return FALSE;
-    }
+    matches[4] = atoi(t);
   }
   else
   {
@@ -987,8 +1160,8 @@ static int getIpAndCidrFromString(char const * const addr, T50_tmp_addr_t *addr_
     }
 
   /* NOTE: Check 'bits' here! */
-  /* Validate cidr. */
-  if (matches[4] < CIDR_MINIMUM || matches[4] > CIDR_MAXIMUM)
+  /* Validate cidr. CIDR_MINIMUM is 0: 'bits' can't be less. */
+  if (matches[4] > CIDR_MAXIMUM)
   {
     char msg[64];
 
@@ -1007,7 +1180,7 @@ static int getIpAndCidrFromString(char const * const addr, T50_tmp_addr_t *addr_
                     (matches[2] << 8)  |
                     (matches[1] << 16) |
                     (matches[0] << 24)) &
-                      (0xffffffffUL << (32 - addr_ptr->cidr));
+                      (addr_ptr->cidr ? 0xffffffffU << (32 - addr_ptr->cidr) : 0);
 
   return TRUE;
 }
@@ -1027,3 +1200,123 @@ static void CheckRangeFromBits(const char *errstr, int bits, int value)
   }
 }
 
+/* Gets a rate, optionally followed by a k, M or G multiplier (ex: 250k, 3G). */
+static double getRateFromString(const char *errstr, const char *str)
+{
+  char *end;
+  double rate;
+
+  rate = strtod(str, &end);
+  switch (*end)
+  {
+    case 'k': case 'K': rate *= 1e3; end++; break;
+    case 'm': case 'M': rate *= 1e6; end++; break;
+    case 'g': case 'G': rate *= 1e9; end++; break;
+  }
+
+  if (end == str || *end != '\0' || rate <= 0)
+  {
+    fprintf(stderr, "ERROR: %s must be a positive rate (ex: 250k, 3G).\n", errstr);
+    exit(EXIT_FAILURE);
+  }
+
+  return rate;
+}
+
+/* Gets a count, optionally followed by a k or M multiplier (ex: 10k, 1M).
+   It must be a whole number from 1 to 2^32 - 1. */
+static uint32_t getCountFromString(const char *errstr, const char *str)
+{
+  unsigned long long count, mult = 1;
+  char *end;
+
+  errno = 0;
+  count = strtoull(str, &end, 10);
+  switch (*end)
+  {
+    case 'k': case 'K': mult = 1000; end++; break;
+    case 'm': case 'M': mult = 1000000; end++; break;
+  }
+
+  /* NOTE: strtoull() takes "-1" as a huge number: digits only. */
+  if (*str < '0' || *str > '9' || *end != '\0' || errno == ERANGE ||
+      count == 0 || count > UINT32_MAX / mult)
+  {
+    fprintf(stderr, "ERROR: %s must be a whole number from 1 to %u (ex: 10k, 1M).\n", errstr, UINT32_MAX);
+    exit(EXIT_FAILURE);
+  }
+
+  return count * mult;
+}
+
+/* Gets the --seed, decimal, hexadecimal (0x) or octal (0), up to 2^64 - 1.
+   A mistyped seed would silently give another run, so anything else is
+   an error. */
+static uint64_t getSeedFromString(const char *str)
+{
+  unsigned long long seed;
+  char *end;
+
+  errno = 0;
+  seed = strtoull(str, &end, 0);
+
+  /* NOTE: strtoull() takes "-1" as a huge number: digits only. */
+  if (*str < '0' || *str > '9' || *end != '\0' || errno == ERANGE)
+  {
+    fprintf(stderr, "ERROR: --seed must be a number from 0 to %" PRIu64 " (ex: 42, 0x2a).\n", UINT64_MAX);
+    exit(EXIT_FAILURE);
+  }
+
+  return seed;
+}
+
+/* Parses "10.0.0.5-10.0.3.200" targets (network order). Returns FALSE if
+   it isn't one: it may still be a name. */
+static int getRangeFromString(const char *str, in_addr_t *first, in_addr_t *last)
+{
+  const char *dash = strchr(str, '-');
+  struct in_addr a, b;
+  char buf[INET_ADDRSTRLEN];
+
+  if (dash == NULL || (size_t)(dash - str) >= sizeof(buf))
+    return FALSE;
+
+  memcpy(buf, str, dash - str);
+  buf[dash - str] = '\0';
+  if (inet_pton(AF_INET, buf, &a) != 1 || inet_pton(AF_INET, dash + 1, &b) != 1)
+    return FALSE;
+
+  /* NOTE: The number of hosts must fit 32 bits. 0.0.0.0/0 is the way to
+           (almost) all of them. */
+  if (ntohl(b.s_addr) < ntohl(a.s_addr) || (a.s_addr == INADDR_ANY && b.s_addr == INADDR_BROADCAST))
+  {
+    fprintf(stderr, "%s: invalid range '%s' (ex: 10.0.0.5-10.0.3.200)\n", PACKAGE, str);
+    exit(EXIT_FAILURE);
+  }
+
+  *first = a.s_addr;
+  *last = b.s_addr;
+  return TRUE;
+}
+
+/* A single port (0 is random) or a list of them ("80,443,8000-8100"). */
+static void getPortsFromString(const char *errstr, const char *str,
+                               uint16_t *port, uint16_t **list, unsigned *count)
+{
+  int tmp;
+
+  free(*list);
+  *list = NULL;
+  *count = 0;
+
+  if (strpbrk(str, ",-") == NULL)
+  {
+    CheckRangeFromBits(errstr, 16, tmp = atoi(str));
+    *port = tmp;
+  }
+  else if (!parsePortList(str, list, count))
+  {
+    fprintf(stderr, "%s: invalid %s list '%s' (ex: 80,443,8000-8100)\n", PACKAGE, errstr, str);
+    exit(EXIT_FAILURE);
+  }
+}
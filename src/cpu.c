@@ -0,0 +1,186 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <common.h>
+#include <sched.h>
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+/* Parses a core list like "2-9,12,14-15".
+   Returns FALSE if the list is invalid. */
+int parseCpuList(const char *str, uint16_t **list, unsigned *count)
+{
+  uint16_t *p = NULL;
+  unsigned n = 0;
+  const char *s = str;
+  char *end;
+  long first, last;
+
+  assert(str != NULL);
+
+  while (*s)
+  {
+    first = strtol(s, &end, 10);
+    if (end == s || first < 0 || first >= CPU_SETSIZE)
+      goto error;
+
+    last = first;
+    if (*end == '-')
+    {
+      s = end + 1;
+      last = strtol(s, &end, 10);
+      if (end == s || last < first || last >= CPU_SETSIZE)
+        goto error;
+    }
+
+    if (*end != ',' && *end != '\0')
+      goto error;
+
+    for (; first <= last; first++)
+    {
+      void *q;
+
+      if ((q = realloc(p, (n + 1) * sizeof(uint16_t))) == NULL)
+      {
+        ERROR("Error allocating cpu list");
+        exit(EXIT_FAILURE);
+      }
+
+      p = q;
+      p[n++] = first;
+    }
+
+    s = (*end == ',') ? end + 1 : end;
+  }
+
+  if (n == 0)
+    goto error;
+
+  *list = p;
+  *count = n;
+  return TRUE;
+
+error:
+  free(p);
+  return FALSE;
+}
+
+/* Gets the NUMA node which owns the cpu, looking for a 'nodeN' entry on sysfs.
+   Returns -1 if unknown (kernels without NUMA support don't have it). */
+int getCpuNode(unsigned cpu)
+{
+  char path[64];
+  DIR *dir;
+  struct dirent *de;
+  int node = -1;
+
+  sprintf(path, "/sys/devices/system/cpu/cpu%u", cpu);
+  if ((dir = opendir(path)) == NULL)
+    return -1;
+
+  while ((de = readdir(dir)) != NULL)
+    if (strncmp(de->d_name, "node", 4) == 0 && de->d_name[4] >= '0' && de->d_name[4] <= '9')
+    {
+      node = atoi(de->d_name + 4);
+      break;
+    }
+
+  closedir(dir);
+  return node;
+}
+
+/* Gets the NUMA node of a network interface (its device). Returns -1 if
+   unknown: virtual interfaces have no device, and single node machines
+   say -1 themselves. */
+int getNetNode(const char *ifname)
+{
+  char path[128];
+  FILE *f;
+  int node = -1;
+
+  assert(ifname != NULL);
+
+  snprintf(path, sizeof(path), "/sys/class/net/%s/device/numa_node", ifname);
+  if ((f = fopen(path, "r")) == NULL)
+    return -1;
+
+  if (fscanf(f, "%d", &node) != 1)
+    node = -1;
+
+  fclose(f);
+  return node;
+}
+
+/* Gets the cores of a NUMA node (same format as --cpus).
+   Returns FALSE if the node list can't be read. */
+int getNodeCpus(int node, uint16_t **list, unsigned *count)
+{
+  char path[64], buffer[4096];
+  FILE *f;
+  size_t n;
+
+  sprintf(path, "/sys/devices/system/node/node%d/cpulist", node);
+  if ((f = fopen(path, "r")) == NULL)
+    return FALSE;
+
+  n = fread(buffer, 1, sizeof(buffer) - 1, f);
+  fclose(f);
+
+  /* NOTE: The list ends with a newline. */
+  while (n > 0 && (buffer[n - 1] == '\n' || buffer[n - 1] == ' '))
+    n--;
+  buffer[n] = '\0';
+
+  return n > 0 && parseCpuList(buffer, list, count);
+}
+
+/* Pins the calling thread to the cpu and makes its future allocations
+   prefer the cpu's NUMA node. Must be called before the worker allocates
+   its buffers (memory is placed on first touch anyway).
+   Returns FALSE on failure. */
+int setThreadPlacement(unsigned cpu, int node)
+{
+  cpu_set_t set;
+
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+
+  if ((errno = pthread_setaffinity_np(pthread_self(), sizeof(set), &set)) != 0)
+  {
+    perror("Error setting worker cpu affinity");
+    return FALSE;
+  }
+
+  /* NOTE: Using the syscall directly to avoid libnuma dependency. */
+  if (node >= 0)
+  {
+    unsigned long mask[MAXIMUM_NUMA_NODES / (8 * sizeof(unsigned long))] = { 0 };
+
+    if (node >= MAXIMUM_NUMA_NODES)
+      return TRUE;
+
+    mask[node / (8 * sizeof(unsigned long))] = 1UL << (node % (8 * sizeof(unsigned long)));
+
+    /* Failure here is not fatal: kernel may not support NUMA policies. */
+    syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask, (unsigned long)node + 2);
+  }
+
+  return TRUE;
+}
@@ -0,0 +1,244 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Flow pool (--flows). Flows are numbered: their place on the pool, plus
+   the pool size for each time they were replaced (--flow-churn). Addresses
+   and ports are keyed hashes of that number, so the pool doesn't depend on
+   the number of workers and a replaced flow is a new one. With --seed, the
+   flow of each packet is picked from its number over the whole pool and
+   made on the spot, so the packets don't depend on it either. */
+
+#include <common.h>
+
+/* Hash keys: source address, source port and destination port. */
+static uint32_t keys[3];
+
+/* Alias tables of the whole pool (ZIPF with --seed), shared by the workers. */
+static uint32_t *pool_prob, *pool_alias;
+
+static void makeFlow(struct flow_pool *, uint32_t, uint64_t);
+static int  buildZipf(uint32_t, uint32_t **, uint32_t **);
+
+/* Draws the keys. Called once, on the main thread, after the seed. */
+int flows_init(const struct config_options *co)
+{
+  int i;
+
+  for (i = 0; i < 3; i++)
+    keys[i] = RANDOM();
+
+  if (co->seed_set && co->flow_mode == FLOW_ZIPF)
+    return buildZipf(co->flows, &pool_prob, &pool_alias);
+
+  return TRUE;
+}
+
+/* Builds the flows of worker 'id' (of 'step' workers). Called by the worker
+   itself, so the tables live on its NUMA node. */
+int flows_create(struct flow_pool *p,
+                 const struct config_options *co,
+                 const struct cidr *cidr,
+                 unsigned id,
+                 unsigned step)
+{
+  uint32_t i;
+
+  memset(p, 0, sizeof(struct flow_pool));
+  p->co = co;
+  p->cidr = cidr;
+  p->id = id;
+  p->step = step;
+  p->n = co->flows / step + (id < co->flows % step);
+
+  /* NOTE: With --seed, one slot holds the flow of the current packet. */
+  if (co->seed_set)
+    p->n = 1;
+
+  p->saddr = malloc(p->n * sizeof(in_addr_t));
+  p->daddr = malloc(p->n * sizeof(in_addr_t));
+  p->sport = malloc(p->n * sizeof(uint16_t));
+  p->dport = malloc(p->n * sizeof(uint16_t));
+  if (p->saddr == NULL || p->daddr == NULL || p->sport == NULL || p->dport == NULL)
+  {
+    ERROR("Error allocating flows");
+    return FALSE;
+  }
+
+  if (co->seed_set)
+    return TRUE;
+
+  for (i = 0; i < p->n; i++)
+    makeFlow(p, i, id + (uint64_t)i * step);
+
+  if (co->flow_mode == FLOW_ZIPF)
+    if (!buildZipf(p->n, &p->prob, &p->alias))
+      return FALSE;
+
+  /* Each worker replaces its share of the flows. */
+  if (co->flow_churn > 0)
+  {
+    p->churn_ns = 1e9 * step / co->flow_churn;
+    p->start = monotonic_ns();
+  }
+
+  return TRUE;
+}
+
+void flows_destroy(struct flow_pool *p)
+{
+  free(p->saddr);
+  free(p->daddr);
+  free(p->sport);
+  free(p->dport);
+  free(p->prob);
+  free(p->alias);
+  memset(p, 0, sizeof(struct flow_pool));
+}
+
+/* Replaces the flows due by now, oldest first. */
+void flows_churn(struct flow_pool *p)
+{
+  uint64_t due = (monotonic_ns() - p->start) / p->churn_ns;
+
+  /* NOTE: After a long stall, replacing every flow once is enough. */
+  if (due > p->churned + p->n)
+    p->churned = due - p->n;
+
+  for (; p->churned < due; p->churned++)
+  {
+    uint32_t i = p->churned % p->n;
+    uint64_t round = p->churned / p->n + 1;
+
+    makeFlow(p, i, round * p->co->flows + p->id + (uint64_t)i * p->step);
+  }
+}
+
+/* Picks the flow of packet 'index' (--seed) and makes it on slot 0. */
+uint32_t flows_seeded(struct flow_pool *p, uint64_t index)
+{
+  const struct config_options *co = p->co;
+  uint32_t num;
+
+  switch (co->flow_mode)
+  {
+    case FLOW_SEQUENTIAL:
+      num = index % co->flows;
+      break;
+
+    case FLOW_RANDOM:
+      num = random_range(co->flows);
+      break;
+
+    default:
+      num = random_range(co->flows);
+      if ((RANDOM() & 0x7fffffff) >= pool_prob[num])
+        num = pool_alias[num];
+  }
+
+  makeFlow(p, 0, num);
+  return 0;
+}
+
+/* Fills flow 'i' as flow number 'num'. Fields given on the command line
+   stay as they are; ports given as lists are picked from them. */
+static void makeFlow(struct flow_pool *p, uint32_t i, uint64_t num)
+{
+  const struct config_options *co = p->co;
+  uint32_t h = num ^ num >> 32;
+  in_addr_t s = co->ip.saddr;
+
+  /* NOTE: One to one, so the first 2^32 flows have distinct sources. Zero
+           would be random on each packet: its flow takes the source of the
+           last number instead. */
+  if (s == INADDR_ANY)
+    if ((s = random_hash32(num, keys[0])) == INADDR_ANY)
+      s = random_hash32(UINT32_MAX, keys[0]);
+
+  p->saddr[i] = s;
+  p->daddr[i] = htonl(cidr_flow_address(p->cidr, co->dest_mode, num));
+  p->sport[i] = co->num_sports ? co->sport_list[random_scale(random_hash32(h, keys[1]), co->num_sports)] :
+                co->source ? co->source : 1 + random_scale(random_hash32(h, keys[1]), 65535);
+  p->dport[i] = co->num_dports ? co->dport_list[random_scale(random_hash32(h, keys[2]), co->num_dports)] :
+                co->dest ? co->dest : 1 + random_scale(random_hash32(h, keys[2]), 65535);
+}
+
+/* Alias tables (Vose, like the --mix ones) for weights 1, 1/2, 1/3, ...
+   Small columns are stacked from the start of 'stack', large ones from
+   its end. */
+static int buildZipf(uint32_t n, uint32_t **probp, uint32_t **aliasp)
+{
+  uint32_t ns = 0, nl = 0, i, *stack, *prob, *alias;
+  double *scaled, sum = 0;
+
+  prob = *probp = malloc(n * sizeof(uint32_t));
+  alias = *aliasp = malloc(n * sizeof(uint32_t));
+  scaled = malloc(n * sizeof(double));
+  stack = malloc(n * sizeof(uint32_t));
+  if (prob == NULL || alias == NULL || scaled == NULL || stack == NULL)
+  {
+    ERROR("Error allocating flow weights");
+    free(scaled);
+    free(stack);
+    return FALSE;
+  }
+
+  for (i = 0; i < n; i++)
+    sum += 1.0 / (i + 1);
+
+  for (i = 0; i < n; i++)
+  {
+    scaled[i] = n / ((i + 1) * sum);
+    if (scaled[i] < 1.0)
+      stack[ns++] = i;
+    else
+      stack[n - ++nl] = i;
+  }
+
+  while (ns && nl)
+  {
+    uint32_t s = stack[--ns], l = stack[n - nl--];
+
+    prob[s]  = (uint32_t)(scaled[s] * 2147483648.0);
+    alias[s] = l;
+
+    scaled[l] -= 1.0 - scaled[s];
+    if (scaled[l] < 1.0)
+      stack[ns++] = l;
+    else
+      stack[n - ++nl] = l;
+  }
+
+  /* NOTE: Whatever is left is (up to rounding) exactly 1. */
+  while (nl)
+  {
+    i = stack[n - nl--];
+    prob[i]  = 0x80000000U;
+    alias[i] = i;
+  }
+  while (ns)
+  {
+    i = stack[--ns];
+    prob[i]  = 0x80000000U;
+    alias[i] = i;
+  }
+
+  free(scaled);
+  free(stack);
+  return TRUE;
+}
@@ -26,8 +26,41 @@ void general_help(void)
        "    --flood                   This option supersedes the \'threshold\'\n"
        "    --encapsulated            Encapsulated protocol (GRE)      (default OFF)\n"
        " -B,--bogus-csum              Bogus checksum                   (default OFF)\n"
+       "    --batch NUM               Packets per send system call     (default 1)\n"
+       "    --cpus LIST               Pin workers to cores (ex: 2-9)   (default NONE)\n"
+       "    --pps RATE                Packets per second (ex: 250k)    (default NONE)\n"
+       "    --bps RATE                Bits per second (ex: 3G)         (default NONE)\n"
+       "    --overhead NONE|L2|L1     Link overhead counted by --bps   (default NONE)\n"
+       "    --stats-interval SEC      Show live rates every SEC secs   (default OFF)\n"
+       "    --report FILE             Write a JSON report at exit      (default NONE)\n"
+       "    --mix LIST                Weighted protocols (ex: TCP:60,UDP:30,ICMP:10)\n"
+       "    --mix-schedule            Interleaved schedule for --mix   (default OFF)\n"
+       "    --no-template             Build every packet from scratch  (default OFF)\n"
+       "    --output TYPE             Output backend                   (default RAW)\n"
+       "                              (RAW, PACKET, XDP, URING, PCAP, PCAPNG or NULL)\n"
+       "    --interface IF            Interface (PACKET and XDP)       (default NONE)\n"
+       "    --dst-mac MAC             Next hop MAC address             (default ARP)\n"
+       "    --qdisc-bypass            Bypass the qdisc layer (PACKET)  (default OFF)\n"
+       "    --csum-offload            Kernel/NIC L4 checksums (PACKET) (default OFF)\n"
+       "    --queue NUM               First interface queue (XDP)      (default 0)\n"
+       "    --xdp-copy                Don't try zero copy (XDP)        (default OFF)\n"
+       "    --busy-poll               Busy poll the driver (XDP)       (default OFF)\n"
+       "    --sqpoll                  Kernel submission thread (URING) (default OFF)\n"
+       "    --write FILE              Capture file (PCAP and PCAPNG)   (default NONE)\n"
+       "    --file-per-worker         One capture file per worker      (default OFF)\n"
+       "    --seed NUM                Reproducible run with this seed  (default TIME)\n"
+       "    --dest-mode MODE          CIDR hosts order                 (default RANDOM)\n"
+       "                              (RANDOM, SEQUENTIAL or PERMUTE)\n"
+       "    --targets-file FILE       Targets list (replaces target)   (default NONE)\n"
+       "    --flows NUM               Packets from a pool of NUM flows (default OFF)\n"
+       "    --flow-mode MODE          Flow of each packet              (default SEQUENTIAL)\n"
+       "                              (SEQUENTIAL, RANDOM or ZIPF)\n"
+       "    --flow-churn RATE         Flows replaced per second        (default 0)\n"
+       "    --port-mode MODE          --sport/--dport lists order      (default SEQUENTIAL)\n"
+       "                              (SEQUENTIAL, RANDOM or PERMUTE)\n"
 #ifdef  __HAVE_TURBO__
-			 "     --turbo                   Extend the performance           (default OFF)\n"
+       "    --turbo                   One worker per online CPU        (default OFF)\n"
+       "    --workers NUM             Number of worker threads         (default 1)\n"
 #endif  /* __HAVE_TURBO__ */
        " -v,--version                 Print version and exit \n"
 			 " -h,--help                    Display this help and exit\n");
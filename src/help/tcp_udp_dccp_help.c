@@ -22,8 +22,9 @@
 void tcp_udp_dccp_help(void)
 {
   puts("DCCP/TCP/UDP Options:\n"
-       "    --sport NUM               DCCP|TCP|UDP source port         (default RANDOM)\n"
-       "    --dport NUM               DCCP|TCP|UDP destination port    (default RANDOM)\n");
+       "    --sport NUM|LIST          DCCP|TCP|UDP source port         (default RANDOM)\n"
+       "    --dport NUM|LIST          DCCP|TCP|UDP destination port    (default RANDOM)\n"
+       "                              (LIST ex: 80,443,8000-8100)\n");
 
 }
 
@@ -30,6 +30,7 @@
 #include <time.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <netdb.h>
 #include <errno.h>
 #include <fcntl.h>
@@ -41,6 +42,7 @@
 #include <sys/time.h>
 #include <sys/socket.h>
 #include <sys/resource.h>
+#include <pthread.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
@@ -58,35 +60,63 @@
 #include <typedefs.h>
 #include <defines.h>
 
+/* NOTE: Declared here because RANDOM() is used by inline functions below. */
+#ifdef __HAVE_RDRAND__
+extern uint32_t readrand(void);
+#endif
+#include <random.h>
+
 #include <config.h>
 #include <help.h>
 #include <modules.h>
+#include <pacing.h>
+#include <stats.h>
+#include <worker.h>
+#include <mix.h>
+#include <targets.h>
+#include <ports.h>
+#include <output.h>
 
 /* NOTE: Protocols and modules definitions are on modules.h now. */
 
-/* The packet buffer. Reallocated as needed! */
-extern void *packet;
-extern size_t current_packet_size; /* available if necessary! updated by alloc_packet(). */
+/* The packet buffer. Reallocated as needed! One per worker thread. */
+extern __thread void *packet;
+extern __thread size_t current_packet_size; /* available if necessary! updated by alloc_packet(). */
 
 /* NOTE: Since this is not a macro, it's here insted of defines.h. */
 extern uint32_t NETMASK_RND(uint32_t);
 
 /* Realloc packet as needed. Used on module functions. */
 extern void alloc_packet(size_t);
+extern void free_packet(void);
 
 /* Common routines used by code */
-extern struct cidr *config_cidr(uint32_t, in_addr_t);
+extern struct cidr *config_cidr(uint32_t, in_addr_t, in_addr_t, const struct targets *);
+extern in_addr_t cidr_address(const struct cidr *, unsigned, uint64_t *, uint32_t *, unsigned);
+extern in_addr_t cidr_flow_address(const struct cidr *, unsigned, uint64_t);
 extern uint16_t cksum(void *, size_t);  /* Checksum calc. */
+extern uint64_t cksum_add(const void *, size_t, uint64_t); /* Partial sum. */
+extern uint16_t cksum_fold(uint64_t);   /* Partial sum to checksum. */
+extern uint16_t cksum_update(uint16_t, uint64_t, uint64_t); /* RFC 1624. */
+extern uint64_t cksum_pseudo(in_addr_t, in_addr_t, uint8_t, uint16_t); /* Pseudo header sum. */
+extern void ip_fill_checksum(void *, size_t); /* IP header checksum, not left to the kernel. */
+extern void cksum_init(void);           /* Picks the fastest cksum for the CPU. */
 extern in_addr_t resolv(char *);  /* Resolve name to ip address. */
-extern int createSocket(void); /* Creates the sending socket */
+extern int createSocket(const struct config_options * const __restrict__, unsigned); /* Creates the worker sending socket */
 extern void closeSocket(void);  /* Close the previously created socket */
 /* Send the actual packet from buffer, with size bytes, using config options. */
 extern int sendPacket(const void * const, size_t, const struct config_options * const __restrict__);
+extern int flushPackets(void);  /* Sends packets still queued by sendPacket() */
+extern void getSendCounters(uint64_t *, uint64_t *); /* Packets sent and syscalls used */
+extern int parseCpuList(const char *, uint16_t **, unsigned *); /* Parses "2-9,12" lists. */
+extern int getCpuNode(unsigned); /* NUMA node of a cpu (-1 if unknown). */
+extern int getNetNode(const char *); /* NUMA node of an interface (-1 if unknown). */
+extern int getNodeCpus(int, uint16_t **, unsigned *); /* Cores of a NUMA node. */
+extern int setThreadPlacement(unsigned, int); /* Pins calling thread to cpu and node. */
 extern void show_version(void); /* Prints version info. */
 extern void usage(void);        /* Prints usage message */
 
-#ifdef __HAVE_RDRAND__
-extern uint32_t readrand(void);
-#endif
+/* NOTE: The template helpers are inline and use the functions above. */
+#include <template.h>
 
 #endif /* __COMMON_H */
@@ -33,8 +33,37 @@ enum {
   OPTION_ENCAPSULATED,
 #ifdef  __HAVE_TURBO__
   OPTION_TURBO,
+  OPTION_WORKERS,
 #endif  /* __HAVE_TURBO__ */
   OPTION_LIST_PROTOCOL,
+  OPTION_BATCH,
+  OPTION_CPUS,
+  OPTION_PPS,
+  OPTION_BPS,
+  OPTION_OVERHEAD,
+  OPTION_STATS_INTERVAL,
+  OPTION_REPORT,
+  OPTION_MIX,
+  OPTION_MIX_SCHEDULE,
+  OPTION_NO_TEMPLATE,
+  OPTION_OUTPUT,
+  OPTION_INTERFACE,
+  OPTION_DST_MAC,
+  OPTION_QDISC_BYPASS,
+  OPTION_CSUM_OFFLOAD,
+  OPTION_QUEUE,
+  OPTION_XDP_COPY,
+  OPTION_BUSY_POLL,
+  OPTION_SQPOLL,
+  OPTION_WRITE,
+  OPTION_FILE_PER_WORKER,
+  OPTION_SEED,
+  OPTION_DEST_MODE,
+  OPTION_TARGETS_FILE,
+  OPTION_FLOWS,
+  OPTION_FLOW_MODE,
+  OPTION_FLOW_CHURN,
+  OPTION_PORT_MODE,
 
   /* XXX DCCP, TCP & UDP HEADER OPTIONS            */
   OPTION_SOURCE,
@@ -260,10 +289,24 @@ enum {
   OPTION_OSPF_AUTH_SEQUENCE,
 };
 
+/* Destination iteration over the CIDR (--dest-mode). */
+enum {
+  DEST_RANDOM = 0,                  /* random host, with repeats   */
+  DEST_SEQUENTIAL,                  /* hosts in order              */
+  DEST_PERMUTE                      /* hosts in a random order     */
+};
+
+/* Feistel rounds of the DEST_PERMUTE permutation. */
+#define CIDR_ROUNDS 4
+
 /* Config structures */
 struct cidr {
   uint32_t  hostid;                 /* hosts identifiers           */
+  uint32_t  slots;                  /* places (hosts and padding)  */
   in_addr_t __1st_addr;             /* first IP address            */
+  unsigned  half_bits;              /* Feistel half width (bits)   */
+  uint32_t  keys[CIDR_ROUNDS];      /* Feistel round keys          */
+  const struct targets *targets;    /* --targets-file (or NULL)    */
 };
 
 struct config_options {
@@ -273,13 +316,53 @@ struct config_options {
   int       encapsulated;           /* GRE encapsulated            */
   int       bogus_csum;             /* bogus packet checksum       */
 #ifdef  __HAVE_TURBO__
-  int       turbo;                  /* duplicate the attack        */
+  int       turbo;                  /* one worker per online CPU   */
+  unsigned  workers;                /* number of worker threads    */
 #endif  /* __HAVE_TURBO__ */
+  unsigned  batch;                  /* packets per send syscall    */
+  uint16_t  *cpu_list;              /* cores used by the workers   */
+  unsigned  num_cpus;               /* number of cores on the list */
+  double    pps;                    /* packets per second target   */
+  double    bps;                    /* bits per second target      */
+  unsigned  overhead;               /* link overhead for 'bps'     */
+  double    stats_interval;         /* live statistics period (s)  */
+  char      *report_file;           /* JSON report file name       */
+  char      *mix;                   /* protocol mix (as given)     */
+  double    *mix_weights;           /* weights, one per module     */
+  int       mix_schedule;           /* use precomputed schedule    */
+  int       no_template;            /* always call the modules     */
+  unsigned  output;                 /* OUTPUT_* backend            */
+  char      *interface;             /* interface (packet and xdp)  */
+  uint8_t   src_mac[ETH_ALEN];      /* interface MAC address       */
+  uint8_t   dst_mac[ETH_ALEN];      /* next hop MAC address        */
+  int       dst_mac_set;            /* dst_mac given by the user   */
+  int       qdisc_bypass;           /* PACKET_QDISC_BYPASS         */
+  int       csum_offload;           /* PACKET_VNET_HDR checksums   */
+  unsigned  queue;                  /* first queue (--output xdp)  */
+  int       queue_set;              /* queue given by the user     */
+  int       xdp_copy;               /* no zero copy                */
+  int       busy_poll;              /* SO_PREFER_BUSY_POLL         */
+  int       sqpoll;                 /* IORING_SETUP_SQPOLL         */
+  char      *write_file;            /* capture file (pcap/pcapng)  */
+  int       file_per_worker;        /* one capture file per worker */
+  uint64_t  seed;                   /* random seed (--seed)        */
+  int       seed_set;               /* reproducible run            */
+  unsigned  dest_mode;              /* DEST_* (--dest-mode)        */
+  char      *targets_file;          /* targets list file name      */
+  uint32_t  flows;                  /* flow pool size (0: none)    */
+  unsigned  flow_mode;              /* FLOW_* (--flow-mode)        */
+  double    flow_churn;             /* flows replaced per second   */
 
   /* XXX DCCP, TCP & UDP HEADER OPTIONS                            */
   uint16_t  source;                 /* general source port         */
   uint16_t  dest;                   /* general destination port    */
+  uint16_t  *sport_list;            /* --sport list (or NULL)      */
+  unsigned  num_sports;             /* ports on the list           */
+  uint16_t  *dport_list;            /* --dport list (or NULL)      */
+  unsigned  num_dports;             /* ports on the list           */
+  unsigned  port_mode;              /* DEST_* (--port-mode)        */
   uint32_t  bits;                   /* CIDR bits                   */
+  in_addr_t range_end;              /* start-end target: last one  */
 
   /* XXX IP HEADER OPTIONS  (IPPROTO_IP = 0)                       */
   struct {
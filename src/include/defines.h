@@ -32,12 +32,25 @@
 /* Initial packet buffer preallocated size (1 kB). */
 #define INITIAL_PACKET_SIZE 1024
 
+/* Maximum number of worker threads (turbo mode). */
+#define MAXIMUM_WORKERS 256
+
+/* Ethernet physical layer overhead (bytes), used by --overhead L1. */
+#define ETH_PREAMBLE_LEN 8    /* preamble + start frame delimiter */
+#define ETH_IFG_LEN      12   /* minimum interframe gap           */
+
+/* Maximum NUMA node number handled on worker placement. */
+#define MAXIMUM_NUMA_NODES 1024
+
+/* Maximum packets per sendmmsg() call (UIO_MAXIOV on Linux). */
+#define MAXIMUM_BATCH 1024
+
 /* #define RAND_MAX 2147483647 */ /* NOTE: Already defined @ stdlib.h */
-#define CIDR_MINIMUM 8
+#define CIDR_MINIMUM 0
 #define CIDR_MAXIMUM 32 // fix #7
 
-/* 24 bits?! */
-#define MAXIMUM_IP_ADDRESSES  16777215
+/* The whole address space (/0), without network and broadcast addresses. */
+#define MAXIMUM_IP_ADDRESSES  4294967294U
 
 /* #define INADDR_ANY 0 */ /* NOTE: Already defined @ linux/in.h */
 #define IPPORT_ANY 0
@@ -61,20 +74,21 @@
 #define FIELD_MUST_BE_NULL NULL
 #define FIELD_MUST_BE_ZERO 0
 
-/* NOTE: This will do nothing. Used only to prevent warnings. */
-#define UNUSED_PARAM(x) { (x) = (x); }
+/* NOTE: This will do nothing. Used only to prevent warnings.
+         A cast, not an assignment: works on const parameters too. */
+#define UNUSED_PARAM(x) { (void)(x); }
 
 /* NOTE: Macro used to test bitmasks */
 #define TEST_BITS(x,bits) ((x) & (bits))
 
 /* Randomizer macros and function */
+/* NOTE: RDRAND is opt-in (make RDRAND=1): hundreds of cycles a draw. */
 #ifdef __HAVE_RDRAND__
 #define RANDOM() readrand()
-#define SRANDOM(x) {}
 #else
-#define RANDOM() random()
-#define SRANDOM(x) { srandom((x)); }
+#define RANDOM() random32()
 #endif
+#define SRANDOM(x) random_seed((x))
 
 #define __RND(foo) (((foo) == 0) ? RANDOM() : (foo))
 #define INADDR_RND(foo) __RND((foo))
@@ -87,8 +101,5 @@
 #define ERROR(s) fprintf(stderr, "%s: %s\n", PACKAGE, s);
 #endif
 
-/* Used to test if "pid" from fork() is from a child process. */
-#define IS_CHILD_PID(p) ((p) == 0)
-
 #endif
 
@@ -0,0 +1,92 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __FLOWS_INCLUDED__
+#define __FLOWS_INCLUDED__
+
+#include <stdint.h>
+#include <netinet/in.h>
+#include <config.h>
+
+/* Flow picked for each packet (--flow-mode). */
+enum {
+  FLOW_SEQUENTIAL = 0,              /* flows in turn               */
+  FLOW_RANDOM,                      /* uniform                     */
+  FLOW_ZIPF                         /* weight 1/rank               */
+};
+
+/* The flows of one worker (--flows): worker N owns flows N, N + workers,
+   ... of the pool. Structure of arrays, values as the options keep them
+   (addresses in network order, ports in host order). */
+struct flow_pool {
+  uint32_t  n;                      /* flows of this worker        */
+  uint32_t  pos;                    /* next flow (SEQUENTIAL)      */
+  in_addr_t *saddr;
+  in_addr_t *daddr;
+  uint16_t  *sport;
+  uint16_t  *dport;
+  uint32_t  *prob;                  /* alias probability (ZIPF)    */
+  uint32_t  *alias;                 /* alias flow (ZIPF)           */
+  double    churn_ns;               /* time between replacements   */
+  uint64_t  start;                  /* churn clock start           */
+  uint64_t  churned;                /* flows replaced so far       */
+  unsigned  id, step;               /* worker and workers          */
+  const struct config_options *co;  /* fixed fields and sizes      */
+  const struct cidr *cidr;          /* destinations                */
+};
+
+extern int  flows_init(const struct config_options *);
+extern int  flows_create(struct flow_pool *, const struct config_options *,
+                         const struct cidr *, unsigned, unsigned);
+extern void flows_destroy(struct flow_pool *);
+extern void flows_churn(struct flow_pool *);
+extern uint32_t flows_seeded(struct flow_pool *, uint64_t);
+
+/* Sets the addresses and ports of packet 'index' from a flow. */
+static inline void flow_next(struct flow_pool *p, struct config_options *co, uint64_t index)
+{
+  uint32_t i;
+
+  if (co->seed_set)
+    i = flows_seeded(p, index);
+  else switch (co->flow_mode)
+  {
+    case FLOW_SEQUENTIAL:
+      i = p->pos;
+      if (++p->pos == p->n)
+        p->pos = 0;
+      break;
+
+    case FLOW_RANDOM:
+      i = random_range(p->n);
+      break;
+
+    default:
+      i = random_range(p->n);
+      if ((RANDOM() & 0x7fffffff) >= p->prob[i])
+        i = p->alias[i];
+  }
+
+  co->ip.saddr = p->saddr[i];
+  co->ip.daddr = p->daddr[i];
+  co->source = p->sport[i];
+  co->dest = p->dport[i];
+}
+
+#endif
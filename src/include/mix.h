@@ -0,0 +1,58 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __MIX_INCLUDED__
+#define __MIX_INCLUDED__
+
+#include <stdint.h>
+
+/* Schedule length. Must be a power of 2. */
+#define MIX_SCHEDULE_SIZE 4096
+
+/* Shared (read only) sampling tables, built by mix_init(). */
+struct mix_table {
+  unsigned  n;                      /* number of modules           */
+  uint32_t  *prob;                  /* alias probability (2^31=1)  */
+  uint8_t   *alias;                 /* alias module index          */
+  uint8_t   *schedule;              /* interleaved module indexes  */
+};
+
+extern struct mix_table mix;
+
+extern int  parseMix(const char *, double **);
+extern int  mix_init(const double *);
+extern void mix_free(void);
+
+/* Picks a module index with the alias method: a single 31 bits draw gives
+   both the column (high part of draw * n) and the coin (low part). */
+static inline unsigned mix_next_alias(void)
+{
+  uint64_t x = (uint64_t)(RANDOM() & 0x7fffffff) * mix.n;
+  unsigned col = x >> 31;
+
+  return ((uint32_t)x & 0x7fffffff) < mix.prob[col] ? col : mix.alias[col];
+}
+
+/* Picks the next module index on the precomputed schedule. */
+static inline unsigned mix_next_scheduled(unsigned *pos)
+{
+  return mix.schedule[(*pos)++ & (MIX_SCHEDULE_SIZE - 1)];
+}
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __OUTPUT_INCLUDED__
+#define __OUTPUT_INCLUDED__
+
+#include <stdint.h>
+
+/* Output backends (--output). Index on output_table[]. */
+enum {
+  OUTPUT_RAW = 0,           /* SOCK_RAW, IPPROTO_RAW (default)   */
+  OUTPUT_PACKET,            /* AF_PACKET, PACKET_TX_RING         */
+  OUTPUT_XDP,               /* AF_XDP, one socket per queue      */
+  OUTPUT_URING,             /* io_uring sendmsg on a raw socket  */
+  OUTPUT_PCAP,              /* pcap file                         */
+  OUTPUT_PCAPNG,            /* pcapng file                       */
+  OUTPUT_NULL               /* discards the packets              */
+};
+
+struct config_options;
+struct cidr;
+
+/* Backend functions. 'setup' runs once, on the main thread, before the
+   workers start (may be NULL), and sees the targets. The others run on each worker; 'open'
+   gets the worker number. Offline backends don't touch the network: they
+   don't need root and aren't paced in real time. */
+struct output_ops {
+  const char *name;
+  int  offline;
+  int  (*setup)(struct config_options * const __restrict__, const struct cidr *);
+  int  (*open)(const struct config_options * const __restrict__, unsigned);
+  int  (*send)(const void * const, size_t, const struct config_options * const __restrict__);
+  int  (*flush)(void);
+  void (*close)(void);
+};
+
+extern const struct output_ops output_table[];
+
+/* Counters reported at exit. Updated by the backends (per worker). */
+extern __thread uint64_t packets_sent;
+extern __thread uint64_t syscalls_made;
+
+extern int getOutputType(const char *);
+extern socket_t openRawSocket(void);
+extern int setupOutput(struct config_options * const __restrict__, const struct cidr *);
+
+/* AF_PACKET backend (packet.c). */
+extern int  packetSetup(struct config_options * const __restrict__, const struct cidr *);
+extern int  packetOpen(const struct config_options * const __restrict__, unsigned);
+extern int  packetSend(const void * const, size_t, const struct config_options * const __restrict__);
+extern int  packetFlush(void);
+extern void packetClose(void);
+extern int  getInterfaceInfo(const char *, int *, int *, int *, uint8_t *);
+
+/* AF_XDP backend (xdp.c). Uses packetSetup() too. */
+extern int  xdpOpen(const struct config_options * const __restrict__, unsigned);
+extern int  xdpSend(const void * const, size_t, const struct config_options * const __restrict__);
+extern int  xdpFlush(void);
+extern void xdpClose(void);
+
+/* io_uring backend (uring.c). */
+extern int  uringOpen(const struct config_options * const __restrict__, unsigned);
+extern int  uringSend(const void * const, size_t, const struct config_options * const __restrict__);
+extern int  uringFlush(void);
+extern void uringClose(void);
+
+/* pcap and pcapng file backend (pcap.c). */
+extern int  pcapSetup(struct config_options * const __restrict__, const struct cidr *);
+extern int  pcapOpen(const struct config_options * const __restrict__, unsigned);
+extern int  pcapSend(const void * const, size_t, const struct config_options * const __restrict__);
+extern int  pcapFlush(void);
+extern void pcapClose(void);
+
+#endif
@@ -0,0 +1,54 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __PACING_INCLUDED__
+#define __PACING_INCLUDED__
+
+#include <stdint.h>
+
+/* Link layer overhead counted by --bps. */
+enum {
+  OVERHEAD_NONE = 0,        /* IP packet only                    */
+  OVERHEAD_L2,              /* + Ethernet header and FCS         */
+  OVERHEAD_L1               /* + preamble, SFD and interframe gap */
+};
+
+/* Token bucket state. One per worker. 
+   NOTE: All times are in nanoseconds of the monotonic clock. */
+struct pacer {
+  double    ns_per_packet;    /* cost of a packet (--pps)          */
+  double    ns_per_bit;       /* cost of a bit (--bps)             */
+  unsigned  overhead;         /* OVERHEAD_* counted by --bps       */
+  double    depth;            /* bucket depth                      */
+  double    next;             /* when the next packet may be sent  */
+  uint64_t  start;            /* first packet timestamp            */
+  uint64_t  last;             /* last packet timestamp             */
+  uint64_t  packets;          /* packets paced                     */
+  uint64_t  bits;             /* bits paced (with overhead)        */
+};
+
+struct config_options;
+
+extern uint64_t monotonic_ns(void);
+extern void pacer_init(struct pacer *, const struct config_options *, unsigned);
+extern void pacer_wait(struct pacer *, size_t);
+extern uint64_t pacer_advance(struct pacer *, size_t);
+extern uint64_t wire_bits(size_t, unsigned);
+
+#endif
@@ -0,0 +1,49 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __PORTS_INCLUDED__
+#define __PORTS_INCLUDED__
+
+#include <stdint.h>
+
+/* Port lists (--sport/--dport "80,443,8000-8100"), expanded at startup
+   to every port, in the order they are sent. --port-mode PERMUTE shuffles
+   the list once, then goes through it like SEQUENTIAL. */
+extern int  parsePortList(const char *, uint16_t **, unsigned *);
+extern void shufflePorts(uint16_t *, unsigned);
+
+/* Port of the next packet. 'pos' is the worker place on the list, moved
+   'step' (the number of workers) ahead on each call, like the hosts of
+   cidr_address(). */
+static inline uint16_t port_next(const uint16_t *list, unsigned n, unsigned mode,
+                                 unsigned *pos, unsigned step)
+{
+  unsigned i;
+
+  if (mode == DEST_RANDOM)
+    return list[random_range(n)];
+
+  i = *pos;
+  if ((*pos += step) >= n)
+    *pos %= n;
+
+  return list[i];
+}
+
+#endif
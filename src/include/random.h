@@ -0,0 +1,106 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __RANDOM_INCLUDED__
+#define __RANDOM_INCLUDED__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* xoshiro256++ state (Blackman & Vigna). One per worker thread, seeded by
+   random_attach(). Not cryptographic: just fast and well distributed. */
+extern __thread uint64_t random_state[4];
+
+extern void random_seed(uint64_t);          /* Base seed, before the workers start. */
+extern void random_attach(unsigned);        /* Seeds the worker generator.          */
+extern void random_init(void);              /* Picks the bulk fill for the CPU.     */
+extern void random_fill(void *, size_t);    /* Fills a buffer with random bytes.    */
+extern void random_bulk(uint32_t *, size_t);/* Fills an array with random words.    */
+extern void random_packet(uint64_t);        /* Stream of packet i (--seed).         */
+
+static inline uint64_t random_rotl(uint64_t x, int k)
+{
+  return (x << k) | (x >> (64 - k));
+}
+
+/* Next 64 bits of the worker stream. */
+static inline uint64_t random_next(void)
+{
+  uint64_t *s = random_state;
+  uint64_t r = random_rotl(s[0] + s[3], 23) + s[0];
+  uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = random_rotl(s[3], 45);
+
+  return r;
+}
+
+/* Keyed hash (murmur3 finalizer). One to one for a given key: used as
+   Feistel round function and to spread numbers over a field. */
+static inline uint32_t random_hash32(uint32_t x, uint32_t key)
+{
+  x ^= key;
+  x ^= x >> 16;
+  x *= 0x85ebca6b;
+  x ^= x >> 13;
+  x *= 0xc2b2ae35;
+  x ^= x >> 16;
+
+  return x;
+}
+
+/* NOTE: The upper bits are the best ones. */
+static inline uint32_t random32(void)
+{
+  return random_next() >> 32;
+}
+
+/* Unbiased random number below 'n' (n > 0), without division: the high
+   half of RANDOM() * n, drawing again only when the low half falls in
+   the few values that would favor some results (Lemire, 2019). The
+   modulo is only computed on that unlikely path. */
+static inline uint32_t random_range(uint32_t n)
+{
+  uint64_t m = (uint64_t)RANDOM() * n;
+
+  if ((uint32_t)m < n)
+  {
+    uint32_t t = -n % n;
+
+    while ((uint32_t)m < t)
+      m = (uint64_t)RANDOM() * n;
+  }
+
+  return m >> 32;
+}
+
+/* Number below 'n' from a hash (random_hash32()), the same way: the high
+   half of h * n. Hashes can't be drawn again, so this is the plain
+   multiply and shift (no division either). */
+static inline uint32_t random_scale(uint32_t h, uint32_t n)
+{
+  return ((uint64_t)h * n) >> 32;
+}
+
+#endif
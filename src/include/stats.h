@@ -0,0 +1,74 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __STATS_INCLUDED__
+#define __STATS_INCLUDED__
+
+#include <stdint.h>
+
+#define CACHE_LINE_SIZE 64
+
+/* Maximum number of modules counted per protocol. */
+#define MAXIMUM_MODULES 32
+
+/* Send errors are counted per errno below this value (the rest goes to 0). */
+#define MAXIMUM_ERRNO   160
+
+/* Per worker counters. Each slot has a single writer (its worker) and
+   takes whole cache lines, so workers never share a line. */
+struct stats {
+  uint64_t  packets;                /* packets sent                */
+  uint64_t  bytes;                  /* bytes sent                  */
+  uint64_t  errors;                 /* send errors (any errno)     */
+  uint64_t  enobufs;                /* send errors with ENOBUFS    */
+  uint64_t  proto[MAXIMUM_MODULES]; /* packets per module          */
+  uint64_t  proto_bytes[MAXIMUM_MODULES]; /* bytes per module      */
+  uint64_t  proto_cycles[MAXIMUM_MODULES]; /* build TSC cycles (null output) */
+  uint64_t  errnos[MAXIMUM_ERRNO];  /* send errors per errno       */
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+/* The calling worker slot. */
+extern __thread struct stats *worker_stats;
+
+/* NOTE: Only the worker writes its slot, so there is no need for a locked
+         read-modify-write. The relaxed store just keeps the reporter from 
+         reading torn values. It compiles to a plain 'mov'. */
+#define STATS_ADD(field, n) \
+  __atomic_store_n(&worker_stats->field, worker_stats->field + (n), __ATOMIC_RELAXED)
+
+/* Counts a send error. */
+#define STATS_ERROR(e) do { \
+    int __e = ((unsigned)(e) < MAXIMUM_ERRNO) ? (e) : 0; \
+    STATS_ADD(errors, 1); \
+    STATS_ADD(errnos[__e], 1); \
+    if ((e) == ENOBUFS) \
+      STATS_ADD(enobufs, 1); \
+  } while (0)
+
+#define STATS_READ(s, field) __atomic_load_n(&(s)->field, __ATOMIC_RELAXED)
+
+extern struct stats *stats_alloc(unsigned);
+extern void stats_free(void);
+extern void stats_attach(unsigned);
+extern void stats_sum(struct stats *);
+extern const struct stats *stats_get(unsigned);
+extern int  startReporter(double);
+extern void stopReporter(void);
+
+#endif
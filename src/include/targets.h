@@ -0,0 +1,117 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __TARGETS_INCLUDED__
+#define __TARGETS_INCLUDED__
+
+#include <stdint.h>
+#include <netinet/in.h>
+
+/* One run of consecutive target addresses. 'start' is the number of
+   hosts on the ranges before it. Ranges are drawn (Vose alias method)
+   with weights their number of hosts: each column keeps its own range
+   with probability prob / 2^31, otherwise gives range 'alias'. */
+struct target_range {
+  uint32_t  start;                  /* index of the first host     */
+  in_addr_t first;                  /* first address (host order)  */
+  uint32_t  slot;                   /* place of the first host     */
+  uint32_t  prob;                   /* alias probability           */
+  uint32_t  alias;                  /* alias range                 */
+};
+
+/* Bucket of 2^shift places: the piece of a range held on it. The places
+   past 'count' are padding. */
+struct target_bucket {
+  in_addr_t first;                  /* first address (host order)  */
+  uint32_t  count;                  /* hosts (1 up to 2^shift)     */
+};
+
+/* Targets loaded by --targets-file: sorted, merged ranges (and one more,
+   starting at 'total'). For the permutation, the ranges are also split at
+   bucket boundaries, so that place s is found on bucket s >> shift alone.
+   Padding takes at most as many places as hosts. */
+struct targets {
+  uint32_t  n;                      /* number of ranges            */
+  uint32_t  total;                  /* number of hosts             */
+  uint32_t  slots;                  /* number of places            */
+  unsigned  shift;                  /* bucket width (log2)         */
+  struct target_range  *range;
+  struct target_bucket *bucket;
+};
+
+extern struct targets *targets_load(const char *);
+
+/* Address (host order) of a random host. */
+static inline in_addr_t targets_random(const struct targets *t)
+{
+  const struct target_range *r = &t->range[random_range(t->n)];
+
+  if ((RANDOM() & 0x7fffffff) >= r->prob)
+    r = &t->range[r->alias];
+
+  return r->first + random_range(r[1].start - r->start);
+}
+
+/* Address (host order) on place 's'. FALSE if it is padding. */
+static inline int targets_slot(const struct targets *t, uint32_t s, in_addr_t *addr)
+{
+  const struct target_bucket *b = &t->bucket[s >> t->shift];
+  uint32_t i = s & ((1U << t->shift) - 1);
+
+  if (i >= b->count)
+    return FALSE;
+
+  *addr = b->first + i;
+  return TRUE;
+}
+
+/* Range holding the host index 'i', searched from range '*hint' (0 if
+   unknown) on. Walking the hosts, that is a single test while on the same
+   range, and the log of the ranges passed over otherwise (galloping). */
+static inline const struct target_range *targets_seek(const struct targets *t, uint32_t i, uint32_t *hint)
+{
+  uint32_t lo = *hint, hi, step = 1;
+
+  if (lo >= t->n || t->range[lo].start > i)
+    lo = 0;
+
+  for (hi = lo + 1; hi < t->n && t->range[hi].start <= i; hi = lo + step)
+  {
+    lo = hi;
+    step *= 2;
+  }
+  if (hi > t->n)
+    hi = t->n;
+
+  /* NOTE: Now 'i' is on one of range[lo] to range[hi - 1]. */
+  while (hi - lo > 1)
+  {
+    uint32_t mid = lo + (hi - lo) / 2;
+
+    if (t->range[mid].start <= i)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  *hint = lo;
+  return &t->range[lo];
+}
+
+#endif
@@ -0,0 +1,282 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __TEMPLATE_INCLUDED__
+#define __TEMPLATE_INCLUDED__
+
+#include <stdint.h>
+
+/* Maximum number of layouts a module may have (see t_key()). */
+#define TEMPLATE_MAX_VARIANTS 4
+
+/* Template operations, applied in the order they were recorded. */
+enum template_op_type {
+  TOP_RND8 = 0,       /* RANDOM(), 1 byte                          */
+  TOP_RND16,          /* RANDOM(), htons()                         */
+  TOP_RND32,          /* RANDOM(), htonl()                         */
+  TOP_RND24,          /* RANDOM() << 8, htonl()                    */
+  TOP_RAW16,          /* RANDOM(), 2 bytes as is (bogus checksums) */
+  TOP_RAW32,          /* RANDOM(), 4 bytes as is (addresses)       */
+  TOP_NETMASK,        /* NETMASK_RND(0)                            */
+  TOP_BYTES,          /* 'len' random bytes                        */
+  TOP_SADDR,          /* INADDR_RND(co->ip.saddr)                  */
+  TOP_DADDR,          /* co->ip.daddr                              */
+  TOP_SPORT,          /* htons(IPPORT_RND(co->source))             */
+  TOP_DPORT,          /* htons(IPPORT_RND(co->dest))               */
+  TOP_KEY8,           /* the key drawn by t_key()                  */
+  TOP_BITS,           /* RANDOM() on a bit field ('src' is the mask, 'len' the shift) */
+  TOP_COPY,           /* copy 'len' bytes from 'src'               */
+  TOP_CKSUM,          /* cksum() of 'len' bytes from 'src'         */
+  TOP_CKSUM_PSD,      /* TOP_CKSUM plus the pseudo header of the IP header at 'psd' */
+  TOP_PSEUDO          /* pseudo header sum only, for checksum offload (see t_cksum_psd()) */
+};
+
+struct template_op {
+  uint16_t  type;
+  uint16_t  offset;                 /* field offset on the packet  */
+  uint16_t  src;                    /* source offset (COPY, CKSUM) */
+  uint16_t  len;                    /* length (BYTES, COPY, CKSUM) */
+  uint16_t  psd;                    /* IP header offset (CKSUM_PSD) */
+};
+
+/* A rendered packet and the operations which make the next one. */
+struct template {
+  void      *bytes;                 /* packet as first rendered    */
+  size_t    size;
+  struct template_op *ops;
+  unsigned  nops;
+  unsigned  max_ops;
+};
+
+/* Recording state. Not NULL only while a module renders its template. */
+struct template_rec {
+  struct template *t;
+  int       supported;              /* module called TEMPLATE_SUPPORTED()  */
+  int       invalid;                /* packet can't be a template          */
+  unsigned  (*key_fn)(uint32_t);    /* layout selector (see t_key())       */
+  uint32_t  key;                    /* key drawn (or forced)               */
+  int       forced;                 /* use 'key' instead of drawing        */
+};
+
+extern __thread struct template_rec *template_rec;
+
+extern void template_record(int, const void *, const void *, size_t);
+extern void template_record_bits(const void *, const void *, size_t);
+extern void template_record_psd(int, const void *, const void *, size_t, const void *);
+extern int  template_build(unsigned, const struct config_options * const __restrict__, size_t *);
+extern void template_free(void);
+
+/* --- Used by the modules. ---
+
+   Each helper writes a field exactly as the module used to, and records how
+   to make it again when the module is rendering its template. Fields written
+   without helpers are constant: everything a module draws must go through
+   them, in the same order, or the module must not call TEMPLATE_SUPPORTED(). */
+
+/* The module renders complete templates. */
+#define TEMPLATE_SUPPORTED() \
+  { if (template_rec) template_rec->supported = 1; }
+
+/* This packet can't be a template (a random draw changes the layout). */
+#define TEMPLATE_INVALID() \
+  { if (template_rec) template_rec->invalid = 1; }
+
+#define T_RECORD(type, p, src, len, cond) \
+  { if (__builtin_expect(template_rec != NULL, 0) && (cond)) template_record((type), (p), (src), (len)); }
+
+static inline void t_rnd8(void *p, uint32_t foo)
+{
+  *(uint8_t *)p = __RND(foo);
+  T_RECORD(TOP_RND8, p, NULL, 1, foo == 0);
+}
+
+static inline void t_rnd16(void *p, uint32_t foo)
+{
+  *(uint16_t *)p = htons(__RND(foo));
+  T_RECORD(TOP_RND16, p, NULL, 2, foo == 0);
+}
+
+static inline void t_rnd32(void *p, uint32_t foo)
+{
+  *(uint32_t *)p = htonl(__RND(foo));
+  T_RECORD(TOP_RND32, p, NULL, 4, foo == 0);
+}
+
+/* Stores __RND(foo) as is (host order). */
+static inline void t_raw16(void *p, uint32_t foo)
+{
+  *(uint16_t *)p = __RND(foo);
+  T_RECORD(TOP_RAW16, p, NULL, 2, foo == 0);
+}
+
+/* Stores __RND(foo) on a bit field. Since bit fields have no address, the
+   field position is found by setting all its bits on an empty structure.
+   NOTE: The field must not cross a byte boundary. */
+#define t_bitfield(s, field, foo) \
+  do { \
+    uint32_t __foo = (foo); \
+    (s)->field = __RND(__foo); \
+    if (__builtin_expect(template_rec != NULL, 0) && __foo == 0) \
+    { \
+      __typeof__(*(s)) __mask; \
+      memset(&__mask, 0, sizeof(__mask)); \
+      __mask.field = -1; \
+      template_record_bits((s), &__mask, sizeof(__mask)); \
+    } \
+  } while (0)
+
+/* Stores htonl(__RND(foo) << 8) (24 bits fields). */
+static inline void t_rnd24(void *p, uint32_t foo)
+{
+  *(uint32_t *)p = htonl(__RND(foo) << 8);
+  T_RECORD(TOP_RND24, p, NULL, 4, foo == 0);
+}
+
+/* Stores INADDR_RND(foo). */
+static inline void t_addr(void *p, in_addr_t foo)
+{
+  *(in_addr_t *)p = INADDR_RND(foo);
+  T_RECORD(TOP_RAW32, p, NULL, 4, foo == 0);
+}
+
+static inline void t_netmask(void *p, uint32_t foo)
+{
+  *(in_addr_t *)p = NETMASK_RND(foo);
+  T_RECORD(TOP_NETMASK, p, NULL, 4, foo == 0);
+}
+
+/* Fills 'n' random bytes. */
+static inline void t_bytes(void *p, size_t n)
+{
+  T_RECORD(TOP_BYTES, p, NULL, n, n > 0);
+  random_fill(p, n);
+}
+
+/* Fields from per packet options. Always recorded. */
+static inline void t_saddr(void *p, const struct config_options * const __restrict__ co)
+{
+  *(in_addr_t *)p = INADDR_RND(co->ip.saddr);
+  T_RECORD(TOP_SADDR, p, NULL, 4, 1);
+}
+
+static inline void t_daddr(void *p, const struct config_options * const __restrict__ co)
+{
+  *(in_addr_t *)p = co->ip.daddr;
+  T_RECORD(TOP_DADDR, p, NULL, 4, 1);
+}
+
+static inline void t_sport(void *p, const struct config_options * const __restrict__ co)
+{
+  *(uint16_t *)p = htons(IPPORT_RND(co->source));
+  T_RECORD(TOP_SPORT, p, NULL, 2, 1);
+}
+
+static inline void t_dport(void *p, const struct config_options * const __restrict__ co)
+{
+  *(uint16_t *)p = htons(IPPORT_RND(co->dest));
+  T_RECORD(TOP_DPORT, p, NULL, 2, 1);
+}
+
+/* Copies a field (which may be variable) to another place of the packet. */
+static inline void t_copy(void *p, const void *src, size_t len)
+{
+  memcpy(p, src, len);
+  T_RECORD(TOP_COPY, p, src, len, 1);
+}
+
+/* Computes the checksum of 'len' bytes at 'data' into 'field' (or a random
+   value if bogus). The field is zeroed first. */
+static inline void t_cksum(void *field, void *data, size_t len, int bogus)
+{
+  if (bogus)
+  {
+    *(uint16_t *)field = RANDOM();
+    T_RECORD(TOP_RAW16, field, NULL, 2, 1);
+  }
+  else
+  {
+    *(uint16_t *)field = 0;
+    *(uint16_t *)field = cksum(data, len);
+    T_RECORD(TOP_CKSUM, field, data, len, 1);
+  }
+}
+
+/* The TCP, UDP or DCCP checksum is left to the kernel (--csum-offload).
+   NOTE: Only one checksum per frame can be: the GRE one goes first. */
+#define CSUM_OFFLOAD_L4(co) \
+  ((co)->csum_offload && !((co)->encapsulated && TEST_BITS((co)->gre.options, GRE_OPTION_CHECKSUM)))
+
+/* Like t_cksum(), for UDP, TCP and DCCP: the pseudo header is taken from 'ip'
+   (addresses and protocol) and 'len', and summed apart. With checksum
+   offload the field only gets the pseudo header sum, not complemented:
+   the kernel adds the segment. */
+static inline void t_cksum_psd(void *field, void *data, size_t len, const struct iphdr *ip,
+                               const struct config_options * const __restrict__ co)
+{
+  uint64_t sum = cksum_pseudo(ip->saddr, ip->daddr, ip->protocol, len);
+
+  if (co->bogus_csum)
+  {
+    *(uint16_t *)field = RANDOM();
+    T_RECORD(TOP_RAW16, field, NULL, 2, 1);
+  }
+  else if (CSUM_OFFLOAD_L4(co))
+  {
+    *(uint16_t *)field = ~cksum_fold(sum);
+    if (__builtin_expect(template_rec != NULL, 0))
+      template_record_psd(TOP_PSEUDO, field, data, len, ip);
+  }
+  else
+  {
+    *(uint16_t *)field = 0;
+    *(uint16_t *)field = cksum_fold(cksum_add(data, len, sum));
+    if (__builtin_expect(template_rec != NULL, 0))
+      template_record_psd(TOP_CKSUM_PSD, field, data, len, ip);
+  }
+}
+
+/* Draws a value which changes the packet layout. 'fn' maps it to a layout
+   (0 to TEMPLATE_MAX_VARIANTS-1), and each layout gets its own template.
+   Must be the first draw of the module. */
+static inline uint32_t t_key(uint32_t foo, unsigned (*fn)(uint32_t))
+{
+  uint32_t v;
+
+  if (foo != 0)
+    return foo;
+
+  if (template_rec != NULL)
+  {
+    v = template_rec->forced ? template_rec->key : (uint32_t)RANDOM();
+    template_rec->key = v;
+    template_rec->key_fn = fn;
+    return v;
+  }
+
+  return RANDOM();
+}
+
+/* Stores a key drawn by t_key() (1 byte). */
+static inline void t_key8(void *p, uint32_t key)
+{
+  *(uint8_t *)p = key;
+  T_RECORD(TOP_KEY8, p, NULL, 1, template_rec->key_fn != NULL);
+}
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef __WORKER_INCLUDED__
+#define __WORKER_INCLUDED__
+
+#include <stdint.h>
+#include <pthread.h>
+#include <config.h>
+#include <pacing.h>
+#include <flows.h>
+
+/* Worker thread state. Each worker has its own copy of the options,
+   its own socket and packet buffer (both thread local). */
+struct worker {
+  pthread_t tid;
+  unsigned  id;
+  int       status;                 /* EXIT_SUCCESS or EXIT_FAILURE */
+  uint64_t  packets;                /* packets sent                 */
+  uint64_t  syscalls;               /* send system calls used       */
+  uint64_t  cpu_ns;                 /* thread CPU time              */
+  int       cpu;                    /* pinned core (-1 if none)     */
+  int       node;                   /* NUMA node of the core        */
+  unsigned  mix_pos;                /* position on the mix schedule */
+  uint64_t  dest_pos;               /* position on the CIDR hosts   */
+  uint32_t  dest_range;             /* its --targets-file range     */
+  unsigned  sport_pos;              /* position on the --sport list */
+  unsigned  dport_pos;              /* position on the --dport list */
+  struct pacer pacer;               /* rate limiter state           */
+  struct flow_pool flows;           /* worker share of --flows      */
+  struct config_options co;         /* options given to the worker  */
+};
+
+/* Run times, used by the report. */
+struct run_times {
+  uint64_t  wall_ns;                /* workers start to finish      */
+  uint64_t  tsc_cycles;             /* TSC ticks on the same period */
+};
+
+extern uint64_t read_tsc(void);
+extern int writeReport(const char *,
+                       const struct config_options *,
+                       const struct worker *,
+                       unsigned,
+                       const struct run_times *);
+
+#endif
@@ -0,0 +1,214 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <common.h>
+
+struct mix_table mix;
+
+static void build_alias(const double *, unsigned);
+static void build_schedule(const double *, unsigned);
+
+/* Parses a mix like "TCP:60,UDP:30,ICMP:10" into a weights array, one
+   entry per module on mod_table. Returns FALSE if the mix is invalid. */
+int parseMix(const char *str, double **weights)
+{
+  unsigned n = getNumberOfRegisteredModules();
+  double *w, sum = 0;
+  char *s, *p, *tok, *end;
+  unsigned i;
+
+  if ((w = calloc(n, sizeof(double))) == NULL || (s = strdup(str)) == NULL)
+  {
+    ERROR("Error allocating protocol mix");
+    exit(EXIT_FAILURE);
+  }
+
+  for (tok = strtok_r(s, ",", &p); tok != NULL; tok = strtok_r(NULL, ",", &p))
+  {
+    char *colon;
+    double value;
+
+    if ((colon = strchr(tok, ':')) == NULL)
+      goto error;
+    *colon++ = '\0';
+
+    value = strtod(colon, &end);
+    if (end == colon || *end != '\0' || value < 0)
+      goto error;
+
+    for (i = 0; i < n; i++)
+      if (strcasecmp(tok, mod_table[i].acronym) == 0)
+        break;
+
+    if (i == n)
+    {
+      fprintf(stderr, "%s: protocol %s is not implemented\n", PACKAGE, tok);
+      goto error;
+    }
+
+    w[i] += value;
+    sum += value;
+  }
+
+  if (sum <= 0)
+    goto error;
+
+  free(s);
+  free(*weights);
+  *weights = w;
+  return TRUE;
+
+error:
+  free(s);
+  free(w);
+  return FALSE;
+}
+
+/* Builds the alias table and the schedule for the weights. */
+int mix_init(const double *weights)
+{
+  unsigned n = getNumberOfRegisteredModules();
+
+  mix.n        = n;
+  mix.prob     = malloc(n * sizeof(uint32_t));
+  mix.alias    = malloc(n * sizeof(uint8_t));
+  mix.schedule = malloc(MIX_SCHEDULE_SIZE);
+
+  if (mix.prob == NULL || mix.alias == NULL || mix.schedule == NULL)
+  {
+    ERROR("Error allocating protocol mix tables");
+    return FALSE;
+  }
+
+  build_alias(weights, n);
+  build_schedule(weights, n);
+  return TRUE;
+}
+
+void mix_free(void)
+{
+  free(mix.prob);
+  free(mix.alias);
+  free(mix.schedule);
+  memset(&mix, 0, sizeof(mix));
+}
+
+/* Vose's alias method. Each column keeps its own module with probability
+   prob[i] / 2^31, otherwise gives alias[i]. */
+static void build_alias(const double *weights, unsigned n)
+{
+  double scaled[MAXIMUM_MODULES], sum = 0;
+  unsigned small[MAXIMUM_MODULES], large[MAXIMUM_MODULES];
+  unsigned ns = 0, nl = 0, i;
+
+  for (i = 0; i < n; i++)
+    sum += weights[i];
+
+  for (i = 0; i < n; i++)
+  {
+    scaled[i] = weights[i] * n / sum;
+    if (scaled[i] < 1.0)
+      small[ns++] = i;
+    else
+      large[nl++] = i;
+  }
+
+  while (ns && nl)
+  {
+    unsigned s = small[--ns], l = large[--nl];
+
+    mix.prob[s]  = (uint32_t)(scaled[s] * 2147483648.0);
+    mix.alias[s] = l;
+
+    scaled[l] -= 1.0 - scaled[s];
+    if (scaled[l] < 1.0)
+      small[ns++] = l;
+    else
+      large[nl++] = l;
+  }
+
+  /* NOTE: Whatever is left is (up to rounding) exactly 1. */
+  while (nl)
+  {
+    i = large[--nl];
+    mix.prob[i]  = 0x80000000U;
+    mix.alias[i] = i;
+  }
+  while (ns)
+  {
+    i = small[--ns];
+    mix.prob[i]  = 0x80000000U;
+    mix.alias[i] = i;
+  }
+}
+
+/* Apportions MIX_SCHEDULE_SIZE slots to the modules (largest remainder)
+   and interleaves them with a smooth weighted round robin, so each module
+   is spread evenly on the schedule instead of in bursts. */
+static void build_schedule(const double *weights, unsigned n)
+{
+  unsigned count[MAXIMUM_MODULES], given = 0, i, j;
+  double rem[MAXIMUM_MODULES], sum = 0;
+  long current[MAXIMUM_MODULES];
+
+  for (i = 0; i < n; i++)
+    sum += weights[i];
+
+  for (i = 0; i < n; i++)
+  {
+    double exact = weights[i] * MIX_SCHEDULE_SIZE / sum;
+
+    count[i] = (unsigned)exact;
+    rem[i] = exact - count[i];
+    given += count[i];
+  }
+
+  /* Remaining slots go to the largest remainders. */
+  while (given < MIX_SCHEDULE_SIZE)
+  {
+    unsigned best = 0;
+
+    for (i = 1; i < n; i++)
+      if (rem[i] > rem[best])
+        best = i;
+
+    count[best]++;
+    rem[best] = -1;
+    given++;
+  }
+
+  memset(current, 0, sizeof(current));
+  for (j = 0; j < MIX_SCHEDULE_SIZE; j++)
+  {
+    unsigned best = n;
+
+    for (i = 0; i < n; i++)
+    {
+      if (count[i] == 0)
+        continue;
+
+      current[i] += count[i];
+      if (best == n || current[i] > current[best])
+        best = i;
+    }
+
+    current[best] -= MIX_SCHEDULE_SIZE;
+    mix.schedule[j] = best;
+  }
+}
@@ -39,3 +39,7 @@ BEGIN_MODULES_TABLE
   MODULE_ENTRY(IPPROTO_EIGRP, "EIGRP",  "Enhanced Interior Gateway Routing Protocol", eigrp)
   MODULE_ENTRY(IPPROTO_OSPF,  "OSPF",   "Open Shortest Path First",                   ospf)
 END_MODULES_TABLE
+
+/* FIX: The statistics count packets per module in a fixed array. */
+_Static_assert(sizeof(mod_table) / sizeof(mod_table[0]) <= MAXIMUM_MODULES,
+               "Too many modules. Increase MAXIMUM_MODULES on stats.h");
@@ -39,9 +39,8 @@ void dccp(const struct config_options * const __restrict__ co, size_t *size)
   /* GRE Encapsulated IP Header. */
   struct iphdr * gre_ip;
 
-  /* DCCP header and PSEUDO header. */
+  /* DCCP header. */
   struct dccp_hdr * dccp;
-  struct psdhdr *pseudo;
 
   /* DCCP Headers. */
   struct dccp_hdr_ext * dccp_ext;
@@ -52,6 +51,8 @@ void dccp(const struct config_options * const __restrict__ co, size_t *size)
 
   assert(co != NULL);
 
+  TEMPLATE_SUPPORTED();
+
   greoptlen = gre_opt_len(co->gre.options, co->encapsulated);
   dccp_length = dccp_packet_hdr_len(co->dccp.type);
   dccp_ext_length = (co->dccp.ext ? sizeof(struct dccp_hdr_ext) : 0);
@@ -59,8 +60,7 @@ void dccp(const struct config_options * const __restrict__ co, size_t *size)
     greoptlen               +
     sizeof(struct dccp_hdr) +
     dccp_ext_length         +
-    dccp_length             +
-    sizeof(struct psdhdr);
+    dccp_length;
 
   /* Try to reallocate packet, if necessary */
   alloc_packet(*size);
@@ -77,8 +77,8 @@ void dccp(const struct config_options * const __restrict__ co, size_t *size)
 
   /* DCCP Header structure making a pointer to Packet. */
   dccp                 = (struct dccp_hdr *)((void *)ip + sizeof(struct iphdr) + greoptlen);
-  dccp->dccph_sport    = htons(IPPORT_RND(co->source));
-  dccp->dccph_dport    = htons(IPPORT_RND(co->dest));
+  t_sport(&dccp->dccph_sport, co);
+  t_dport(&dccp->dccph_dport, co);
 
   /*
    * Datagram Congestion Control Protocol (DCCP) (RFC 4340)
@@ -91,8 +91,9 @@ void dccp(const struct config_options * const __restrict__ co, size_t *size)
    */
   dccp->dccph_doff    = co->dccp.doff ?
     co->dccp.doff : (sizeof(struct dccp_hdr) + dccp_length + dccp_ext_length) / 4;
+  dccp->dccph_reserved = FIELD_MUST_BE_ZERO;
   dccp->dccph_type    = co->dccp.type;
-  dccp->dccph_ccval   = __RND(co->dccp.ccval);
+  t_bitfield(dccp, dccph_ccval, co->dccp.ccval);
 
   /*
    * Datagram Congestion Control Protocol (DCCP) (RFC 4340)
@@ -112,8 +113,12 @@ void dccp(const struct config_options * const __restrict__ co, size_t *size)
    *                  options,  network-layer pseudoheader, and the initial
    *                  (CsCov-1)*4 bytes of the packet's application data.
    */
-  dccp->dccph_cscov    = co->dccp.cscov ?
-    (co->dccp.cscov - 1) * 4 : (co->bogus_csum ? RANDOM() : co->dccp.cscov);
+  if (co->dccp.cscov)
+    dccp->dccph_cscov  = (co->dccp.cscov - 1) * 4;
+  else if (co->bogus_csum)
+    t_bitfield(dccp, dccph_cscov, 0);
+  else
+    dccp->dccph_cscov  = 0;
 
   /*
    * Datagram Congestion Control Protocol (DCCP) (RFC 4340)
@@ -155,9 +160,11 @@ void dccp(const struct config_options * const __restrict__ co, size_t *size)
    *       +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
    */
   dccp->dccph_x        = co->dccp.ext;
-  dccp->dccph_seq      = htons(__RND(co->dccp.sequence_01));
-  dccp->dccph_seq2     = co->dccp.ext ? 0 : __RND(co->dccp.sequence_02);
-  dccp->dccph_checksum = 0;
+  t_rnd16(&dccp->dccph_seq, co->dccp.sequence_01);
+  if (co->dccp.ext)
+    dccp->dccph_seq2   = 0;
+  else
+    t_rnd8(&dccp->dccph_seq2, co->dccp.sequence_02);
 
   length  = sizeof(struct dccp_hdr);
 
@@ -168,7 +175,7 @@ void dccp(const struct config_options * const __restrict__ co, size_t *size)
   if (co->dccp.ext)
   {
     dccp_ext = (struct dccp_hdr_ext *)buffer_ptr;
-    dccp_ext->dccph_seq_low = htonl(__RND(co->dccp.sequence_03));
+    t_rnd32(&dccp_ext->dccph_seq_low, co->dccp.sequence_03);
 
     buffer_ptr += sizeof(struct dccp_hdr_ext);
   }
@@ -179,7 +186,7 @@ void dccp(const struct config_options * const __restrict__ co, size_t *size)
     case DCCP_PKT_REQUEST:
       /* DCCP Request Header structure making a pointer to Checksum. */
       dccp_req = (struct dccp_hdr_request *)buffer_ptr;
-      dccp_req->dccph_req_service = htonl(__RND(co->dccp.service));
+      t_rnd32(&dccp_req->dccph_req_service, co->dccp.service);
 
       buffer_ptr += sizeof(struct dccp_hdr_request);
       break;
@@ -188,9 +195,9 @@ void dccp(const struct config_options * const __restrict__ co, size_t *size)
       /* DCCP Response Header structure making a pointer to Checksum. */
       dccp_res = (struct dccp_hdr_response *)buffer_ptr;
       dccp_res->dccph_resp_ack.dccph_reserved1   = FIELD_MUST_BE_ZERO;
-      dccp_res->dccph_resp_ack.dccph_ack_nr_high = htons(__RND(co->dccp.acknowledge_01));
-      dccp_res->dccph_resp_ack.dccph_ack_nr_low  = htonl(__RND(co->dccp.acknowledge_02));
-      dccp_res->dccph_resp_service               = htonl(__RND(co->dccp.service));
+      t_rnd16(&dccp_res->dccph_resp_ack.dccph_ack_nr_high, co->dccp.acknowledge_01);
+      t_rnd32(&dccp_res->dccph_resp_ack.dccph_ack_nr_low, co->dccp.acknowledge_02);
+      t_rnd32(&dccp_res->dccph_resp_service, co->dccp.service);
 
       buffer_ptr += sizeof(struct dccp_hdr_response);
     case DCCP_PKT_DATA:
@@ -205,13 +212,13 @@ void dccp(const struct config_options * const __restrict__ co, size_t *size)
       /* DCCP Acknowledgment Header structure making a pointer to Checksum. */
       dccp_ack = (struct dccp_hdr_ack_bits *)buffer_ptr;
       dccp_ack->dccph_reserved1   = FIELD_MUST_BE_ZERO;
-      dccp_ack->dccph_ack_nr_high = htons(__RND(co->dccp.acknowledge_01));
+      t_rnd16(&dccp_ack->dccph_ack_nr_high, co->dccp.acknowledge_01);
       /* Until DCCP Options implementation. */
       if (co->dccp.type == DCCP_PKT_DATAACK ||
           co->dccp.type == DCCP_PKT_ACK)
         dccp_ack->dccph_ack_nr_low  = htonl(0x00000001);
       else
-        dccp_ack->dccph_ack_nr_low  = htonl(__RND(co->dccp.acknowledge_02));
+        t_rnd32(&dccp_ack->dccph_ack_nr_low, co->dccp.acknowledge_02);
 
       buffer_ptr += sizeof(struct dccp_hdr_ack_bits);
       break;
@@ -220,25 +227,18 @@ void dccp(const struct config_options * const __restrict__ co, size_t *size)
       /* DCCP Reset Header structure making a pointer to Checksum. */
       dccp_rst = (struct dccp_hdr_reset *)buffer_ptr;
       dccp_rst->dccph_reset_ack.dccph_reserved1   = FIELD_MUST_BE_ZERO;
-      dccp_rst->dccph_reset_ack.dccph_ack_nr_high = htons(__RND(co->dccp.acknowledge_01));
-      dccp_rst->dccph_reset_ack.dccph_ack_nr_low  = htonl(__RND(co->dccp.acknowledge_02));
-      dccp_rst->dccph_reset_code                  = __RND(co->dccp.rst_code);
+      t_rnd16(&dccp_rst->dccph_reset_ack.dccph_ack_nr_high, co->dccp.acknowledge_01);
+      t_rnd32(&dccp_rst->dccph_reset_ack.dccph_ack_nr_low, co->dccp.acknowledge_02);
+      t_rnd8(&dccp_rst->dccph_reset_code, co->dccp.rst_code);
 
       buffer_ptr += sizeof(struct dccp_hdr_reset);
       break;
   }
 
-  /* PSEUDO Header structure??? */
-  pseudo = (struct psdhdr *)buffer_ptr;
-  pseudo->saddr = co->encapsulated ? gre_ip->saddr : ip->saddr;
-  pseudo->daddr = co->encapsulated ? gre_ip->daddr : ip->daddr;
-  pseudo->zero  = 0;
-  pseudo->protocol = co->ip.protocol;
-  pseudo->len      = htons(length = buffer_ptr - (void *)dccp);
+  length = buffer_ptr - (void *)dccp;
 
   /* Computing the checksum. */
-  dccp->dccph_checksum = co->bogus_csum ? RANDOM() : 
-    cksum(dccp, length + sizeof(struct psdhdr));
+  t_cksum_psd(&dccp->dccph_checksum, dccp, length, co->encapsulated ? gre_ip : ip, co);
 
   /* Finish GRE encapsulation, if needed */
   gre_checksum(packet, co, *size);
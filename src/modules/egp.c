@@ -36,6 +36,8 @@ void egp(const struct config_options * const __restrict__ co, size_t *size)
 
   assert(co != NULL);
 
+  TEMPLATE_SUPPORTED();
+
   greoptlen = gre_opt_len(co->gre.options, co->encapsulated);
   *size = sizeof(struct iphdr)   +
           greoptlen              +
@@ -65,18 +67,16 @@ void egp(const struct config_options * const __restrict__ co, size_t *size)
   egp->type     = co->egp.type;
   egp->code     = co->egp.code;
   egp->status   = co->egp.status;
-  egp->as       = __RND(co->egp.as);
-  egp->sequence = __RND(co->egp.sequence);
-  egp->check    = 0;
+  t_raw16(&egp->as, co->egp.as);
+  t_raw16(&egp->sequence, co->egp.sequence);
 
   /* EGP Acquire Header structure. */
   egp_acq        = (struct egp_acq_hdr *)((void *)egp + sizeof(struct egp_hdr));
-  egp_acq->hello = __RND(co->egp.hello);
-  egp_acq->poll  = __RND(co->egp.poll);
+  t_raw16(&egp_acq->hello, co->egp.hello);
+  t_raw16(&egp_acq->poll, co->egp.poll);
 
   /* Computing the checksum. */
-  egp->check    = co->bogus_csum ? RANDOM() : 
-    cksum(egp, sizeof(struct egp_hdr) + sizeof(struct egp_acq_hdr));
+  t_cksum(&egp->check, egp, sizeof(struct egp_hdr) + sizeof(struct egp_acq_hdr), co->bogus_csum);
 
   /* GRE Encapsulation takes place. */
   gre_checksum(packet, co, *size);
@@ -58,6 +58,10 @@ void eigrp(const struct config_options * const __restrict__ co, size_t *size)
   /* Try to reallocate packet, if necessary */
   alloc_packet(*size);
 
+  /* NOTE: The workaround bytes are not always written, but are part of
+           the packet (and of the checksum). */
+  memset(packet + *size - 8, 0, 8);
+
   /* IP Header structure making a pointer to Packet. */
   ip = ip_header(packet, *size, co);
 
@@ -155,8 +159,8 @@ void eigrp(const struct config_options * const __restrict__ co, size_t *size)
       /*
        * The Authentication key uses HMAC-MD5 or HMAC-SHA-1 digest.
        */
-      for (counter = 0; counter < stemp; counter++)
-        *buffer.byte_ptr++ = RANDOM();
+      random_fill(buffer.ptr, stemp);
+      buffer.ptr += stemp;
 
       /* DON'T NEED THIS. */
       /* FIXME: Is this correct?!
@@ -69,7 +69,7 @@ struct iphdr *gre_encapsulation(void *buffer, const struct config_options *co, u
       struct gre_key_hdr *gre_key;
 
       gre_key      = (struct gre_key_hdr *)(buffer + offset);
-      gre_key->key = htonl(__RND(co->gre.key));
+      t_rnd32(&gre_key->key, co->gre.key);
 
       offset += GRE_OPTLEN_KEY;
     }
@@ -81,7 +81,7 @@ struct iphdr *gre_encapsulation(void *buffer, const struct config_options *co, u
       struct gre_seq_hdr *gre_seq;
 
       gre_seq          = (struct gre_seq_hdr *)(buffer + offset);
-      gre_seq->sequence = htonl(__RND(co->gre.sequence));
+      t_rnd32(&gre_seq->sequence, co->gre.sequence);
 
       offset += GRE_OPTLEN_SEQUENCE;
     }
@@ -104,16 +104,22 @@ struct iphdr *gre_encapsulation(void *buffer, const struct config_options *co, u
     gre_ip->tos      = ip->tos;
     gre_ip->frag_off = ip->frag_off;
     gre_ip->tot_len  = htons(total_len);
-    gre_ip->id       = ip->id;
+    t_copy(&gre_ip->id, &ip->id, sizeof(ip->id));
     gre_ip->ttl      = ip->ttl;
     gre_ip->protocol = co->ip.protocol;
-    gre_ip->saddr    = co->gre.saddr ? co->gre.saddr : ip->saddr;
-    gre_ip->daddr    = co->gre.daddr ? co->gre.daddr : ip->daddr;
-    gre_ip->check    = 0; /* NOTE: Is it necessary? */
+
+    if (co->gre.saddr)
+      gre_ip->saddr  = co->gre.saddr;
+    else
+      t_copy(&gre_ip->saddr, &ip->saddr, sizeof(in_addr_t));
+
+    if (co->gre.daddr)
+      gre_ip->daddr  = co->gre.daddr;
+    else
+      t_copy(&gre_ip->daddr, &ip->daddr, sizeof(in_addr_t));
 
     /* Computing the checksum. */
-    gre_ip->check    = co->bogus_csum ?
-      RANDOM() : cksum(gre_ip, sizeof(struct iphdr));
+    t_cksum(&gre_ip->check, gre_ip, sizeof(struct iphdr), co->bogus_csum);
 
 #ifdef DUMP_DATA
     dump_grehdr(fdebug, gre);
@@ -139,11 +145,9 @@ void gre_checksum(void *buffer, const struct config_options *co, uint32_t packet
     gre = (struct gre_hdr *)(buffer + sizeof(struct iphdr));
     gre_sum = (struct gre_sum_hdr *)((void *)gre + sizeof(struct gre_hdr));
 
-    /* Computing the checksum. */
-    if (TEST_BITS(co->gre.options, GRE_OPTION_CHECKSUM))
-      gre_sum->check  = co->bogus_csum ?
-        RANDOM() :
-        cksum(gre, packet_size - sizeof(struct iphdr));
+    /* Computing the checksum (left as zero for the kernel, with --csum-offload). */
+    if (TEST_BITS(co->gre.options, GRE_OPTION_CHECKSUM) && !co->csum_offload)
+      t_cksum(&gre_sum->check, gre, packet_size - sizeof(struct iphdr), co->bogus_csum);
   }
 }
 
@@ -35,6 +35,8 @@ void icmp(const struct config_options * const __restrict__ co, size_t *size)
 
   assert(co != NULL);
 
+  TEMPLATE_SUPPORTED();
+
   greoptlen = gre_opt_len(co->gre.options, co->encapsulated);
   *size = sizeof(struct iphdr) +
                 greoptlen            +
@@ -55,15 +57,14 @@ void icmp(const struct config_options * const __restrict__ co, size_t *size)
   icmp                   = (struct icmphdr *)((void *)ip + sizeof(struct iphdr) + greoptlen);
   icmp->type             = co->icmp.type;
   icmp->code             = co->icmp.code;
-  icmp->un.echo.id       = htons(__RND(co->icmp.id));
-  icmp->un.echo.sequence = htons(__RND(co->icmp.sequence));
+  t_rnd16(&icmp->un.echo.id, co->icmp.id);
+  t_rnd16(&icmp->un.echo.sequence, co->icmp.sequence);
   if (co->icmp.type == ICMP_REDIRECT)
     if (co->icmp.code == ICMP_REDIR_HOST || co->icmp.code == ICMP_REDIR_NET)
-      icmp->un.gateway = INADDR_RND(co->icmp.gateway);
-  icmp->checksum = 0;
+      t_addr(&icmp->un.gateway, co->icmp.gateway);
 
   /* Computing the checksum. */
-  icmp->checksum = co->bogus_csum ? RANDOM() : cksum(icmp, sizeof(struct icmphdr));
+  t_cksum(&icmp->checksum, icmp, sizeof(struct icmphdr), co->bogus_csum);
 
   /* GRE Encapsulation takes place. */
   gre_checksum(packet, co, *size);
@@ -32,6 +32,8 @@ void igmpv1(const struct config_options * const __restrict__ co, size_t *size)
 
   assert(co != NULL);
 
+  TEMPLATE_SUPPORTED();
+
   /* GRE options size. */
   greoptlen = gre_opt_len(co->gre.options, co->encapsulated);
 
@@ -55,11 +57,10 @@ void igmpv1(const struct config_options * const __restrict__ co, size_t *size)
   igmpv1        = (struct igmphdr *)((void *)ip + sizeof(struct iphdr) + greoptlen);
   igmpv1->type  = co->igmp.type;
   igmpv1->code  = co->igmp.code;
-  igmpv1->group = INADDR_RND(co->igmp.group);
-  igmpv1->csum  = 0;  /* Needed 'cause cksum() call, below! */
+  t_addr(&igmpv1->group, co->igmp.group);
 
   /* Computing the checksum. */
-  igmpv1->csum  = co->bogus_csum ? RANDOM() : cksum(igmpv1, sizeof(struct igmphdr));
+  t_cksum(&igmpv1->csum, igmpv1, sizeof(struct igmphdr), co->bogus_csum);
 
   /* GRE Encapsulation takes place. */
   gre_checksum(packet, co, *size);
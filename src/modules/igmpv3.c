@@ -38,6 +38,8 @@ void igmpv3(const struct config_options * const __restrict__ co, size_t *size)
 
   assert(co != NULL);
 
+  TEMPLATE_SUPPORTED();
+
   greoptlen = gre_opt_len(co->gre.options, co->encapsulated);
   *size = sizeof(struct iphdr) +
     greoptlen            +
@@ -63,27 +65,25 @@ void igmpv3(const struct config_options * const __restrict__ co, size_t *size)
     igmpv3_report->resv1    = FIELD_MUST_BE_ZERO;
     igmpv3_report->resv2    = FIELD_MUST_BE_ZERO;
     igmpv3_report->ngrec    = htons(1);
-    igmpv3_report->csum     = 0;
 
     /* IGMPv3 Group Record Header structure making a pointer to Checksum. */
     igmpv3_grec                = (void *)igmpv3_report + sizeof(struct igmpv3_report);
-    igmpv3_grec->grec_type     = __RND(co->igmp.grec_type);
+    t_rnd8(&igmpv3_grec->grec_type, co->igmp.grec_type);
     igmpv3_grec->grec_auxwords = FIELD_MUST_BE_ZERO;
     igmpv3_grec->grec_nsrcs    = htons(co->igmp.sources);
-    igmpv3_grec->grec_mca      = INADDR_RND(co->igmp.grec_mca);
+    t_addr(&igmpv3_grec->grec_mca, co->igmp.grec_mca);
 
     /* Dealing with source address(es). */
     buffer.ptr = (void *)igmpv3_grec + sizeof(struct igmpv3_grec);
     for (counter = 0; counter < co->igmp.sources; counter++)
-      *buffer.inaddr_ptr++ = INADDR_RND(co->igmp.address[counter]);
+      t_addr(buffer.inaddr_ptr++, co->igmp.address[counter]);
 
     /* Computing the checksum. */
-    igmpv3_report->csum     = co->bogus_csum ?
-      RANDOM() :
-      cksum(igmpv3_report, 
+    t_cksum(&igmpv3_report->csum, igmpv3_report,
         sizeof(struct igmpv3_report) + 
         sizeof(struct igmpv3_grec)   + 
-        IGMPV3_TLEN_NSRCS(co->igmp.sources));
+        IGMPV3_TLEN_NSRCS(co->igmp.sources),
+        co->bogus_csum);
   }
   else
   {
@@ -91,23 +91,22 @@ void igmpv3(const struct config_options * const __restrict__ co, size_t *size)
     igmpv3_query           = (struct igmpv3_query *)((void *)ip + sizeof(struct iphdr) + greoptlen);
     igmpv3_query->type     = co->igmp.type;
     igmpv3_query->code     = co->igmp.code;
-    igmpv3_query->group    = INADDR_RND(co->igmp.group);
+    t_addr(&igmpv3_query->group, co->igmp.group);
+    igmpv3_query->resv     = FIELD_MUST_BE_ZERO;
     igmpv3_query->suppress = co->igmp.suppress;
-    igmpv3_query->qrv      = __RND(co->igmp.qrv);
-    igmpv3_query->qqic     = __RND(co->igmp.qqic);
+    t_bitfield(igmpv3_query, qrv, co->igmp.qrv);
+    t_rnd8(&igmpv3_query->qqic, co->igmp.qqic);
     igmpv3_query->nsrcs    = htons(co->igmp.sources);
-    igmpv3_query->csum     = 0;
 
     /* Dealing with source address(es). */
     buffer.ptr = (void *)igmpv3_query + sizeof(struct igmpv3_query);
     for (counter = 0; counter < co->igmp.sources; counter++)
-      *buffer.inaddr_ptr++ = INADDR_RND(co->igmp.address[counter]);
+      t_addr(buffer.inaddr_ptr++, co->igmp.address[counter]);
 
     /* Computing the checksum. */
-    igmpv3_query->csum     = co->bogus_csum ?
-      RANDOM() :
-      cksum(igmpv3_query, 
-        buffer.ptr - (void *)igmpv3_query);
+    t_cksum(&igmpv3_query->csum, igmpv3_query,
+        buffer.ptr - (void *)igmpv3_query,
+        co->bogus_csum);
   }
 
   /* GRE Encapsulation takes place. */
@@ -36,11 +36,11 @@ struct iphdr *ip_header(void *buffer, size_t packet_size, const struct config_op
   ip->tos      = co->ip.tos;
   ip->frag_off = htons(co->ip.frag_off ? (co->ip.frag_off >> 3) | IP_MF : co->ip.frag_off | IP_DF);
   ip->tot_len  = htons(packet_size);
-  ip->id       = htons(__RND(co->ip.id));
+  t_rnd16(&ip->id, co->ip.id);
   ip->ttl      = co->ip.ttl;
   ip->protocol = co->encapsulated ? IPPROTO_GRE : co->ip.protocol;
-  ip->saddr    = INADDR_RND(co->ip.saddr);
-  ip->daddr    = co->ip.daddr;
+  t_saddr(&ip->saddr, co);
+  t_daddr(&ip->daddr, co);
   /* The code does not have to handle the checksum. Kernel will do */
   ip->check    = 0;
 
@@ -28,8 +28,7 @@ void ipsec(const struct config_options * const __restrict__ co, size_t *size)
 {
   size_t greoptlen,   /* GRE options size. */
          ip_ah_icv,   /* IPSec AH Integrity Check Value (ICV). */
-         esp_data,    /* IPSec ESP Data Encrypted (RANDOM). */
-         counter;
+         esp_data;    /* IPSec ESP Data Encrypted (RANDOM). */
 
   /* Packet. */
   mptr_t buffer;
@@ -42,6 +41,8 @@ void ipsec(const struct config_options * const __restrict__ co, size_t *size)
 
   assert(co != NULL);
 
+  TEMPLATE_SUPPORTED();
+
   greoptlen = gre_opt_len(co->gre.options, co->encapsulated);
   ip_ah_icv = sizeof(uint32_t) * 3;
   esp_data  = auth_hmac_md5_len(1);
@@ -91,25 +92,25 @@ void ipsec(const struct config_options * const __restrict__ co, size_t *size)
   ip_auth->hdrlen  = co->ipsec.ah_length ?
     co->ipsec.ah_length :
     (sizeof(struct ip_auth_hdr)/4) + (ip_ah_icv/ip_ah_icv);
-  ip_auth->spi     = htonl(__RND(co->ipsec.ah_spi));
-  ip_auth->seq_no  = htonl(__RND(co->ipsec.ah_sequence));
+  ip_auth->reserved = FIELD_MUST_BE_ZERO;
+  t_rnd32(&ip_auth->spi, co->ipsec.ah_spi);
+  t_rnd32(&ip_auth->seq_no, co->ipsec.ah_sequence);
 
   buffer.ptr = (void *)ip_auth + sizeof(struct ip_auth_hdr);
 
   /* Setting a fake encrypted content. */
-  for (counter = 0; counter < ip_ah_icv; counter++)
-    *buffer.byte_ptr++ = RANDOM();
+  t_bytes(buffer.ptr, ip_ah_icv);
+  buffer.ptr += ip_ah_icv;
 
   /* IPSec ESP Header structure making a pointer to Checksum. */
   ip_esp         = (struct ip_esp_hdr *)buffer.ptr;
-  ip_esp->spi    = htonl(__RND(co->ipsec.esp_spi));
-  ip_esp->seq_no = htonl(__RND(co->ipsec.esp_sequence));
+  t_rnd32(&ip_esp->spi, co->ipsec.esp_spi);
+  t_rnd32(&ip_esp->seq_no, co->ipsec.esp_sequence);
 
   buffer.ptr += sizeof(struct ip_esp_hdr);
 
   /* Setting a fake encrypted content. */
-  for (counter = 0; counter < esp_data; counter++)
-    *buffer.byte_ptr++ = RANDOM();
+  t_bytes(buffer.ptr, esp_data);
 
   /* GRE Encapsulation takes place. */
   gre_checksum(packet, co, *size);
@@ -23,6 +23,7 @@
  * prototypes.
  */
 static size_t ospf_hdr_len(const uint8_t, const uint8_t, const uint8_t, const uint8_t);
+static unsigned ospf_variant(uint32_t);
 
 /* Function Name: OSPF packet header configuration.
 
@@ -55,8 +56,10 @@ void ospf(const struct config_options * const __restrict__ co, size_t *size)
 
   assert(co != NULL);
 
+  TEMPLATE_SUPPORTED();
+
   greoptlen = gre_opt_len(co->gre.options, co->encapsulated);
-  ospf_options = __RND(co->ospf.options);
+  ospf_options = t_key(co->ospf.options, ospf_variant);
   lls = TEST_BITS(ospf_options, OSPF_OPTION_LLS) ? 1 : 0;
   ospf_length = ospf_hdr_len(co->ospf.type, co->ospf.neighbor, co->ospf.lsa_type, co->ospf.dd_include_lsa);
 
@@ -102,8 +105,11 @@ void ospf(const struct config_options * const __restrict__ co, size_t *size)
       sizeof(struct ospf_hdr)      +
       sizeof(struct ospf_auth_hdr) +
       ospf_length);
-  ospf->rid     = INADDR_RND(co->ospf.rid);
-  ospf->aid     = co->ospf.AID ? INADDR_RND(co->ospf.aid) : co->ospf.aid;
+  t_addr(&ospf->rid, co->ospf.rid);
+  if (co->ospf.AID)
+    t_addr(&ospf->aid, co->ospf.aid);
+  else
+    ospf->aid   = co->ospf.aid;
   ospf->check   = 0;
 
   /* OSPF Authentication Header structure making a pointer to OSPF Header structure. */
@@ -128,9 +134,9 @@ void ospf(const struct config_options * const __restrict__ co, size_t *size)
      */
     ospf->autype        = htons(AUTH_TYPE_HMACMD5);
     //ospf_auth->reserved = FIELD_MUST_BE_ZERO;
-    ospf_auth->key_id   = __RND(co->ospf.key_id);
+    t_bitfield(ospf_auth, key_id, co->ospf.key_id);
     ospf_auth->length   = auth_hmac_md5_len(co->ospf.auth);
-    ospf_auth->sequence = htonl(__RND(co->ospf.sequence));
+    t_rnd32(&ospf_auth->sequence, co->ospf.sequence);
   }
   else
   {
@@ -184,19 +190,19 @@ void ospf(const struct config_options * const __restrict__ co, size_t *size)
        *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
        *  |                              ...                              |
        */
-      *buffer.inaddr_ptr++ = NETMASK_RND(co->ospf.netmask);
-      *buffer.word_ptr++ = htons(__RND(co->ospf.hello_interval));
-      *buffer.byte_ptr++ = ospf_options;
-      *buffer.byte_ptr++ = __RND(co->ospf.hello_priority);
-      *buffer.dword_ptr++ = htonl(__RND(co->ospf.hello_dead));
-      *buffer.inaddr_ptr++ = INADDR_RND(co->ospf.hello_design);
-      *buffer.inaddr_ptr++ = INADDR_RND(co->ospf.hello_backup);
+      t_netmask(buffer.inaddr_ptr++, co->ospf.netmask);
+      t_rnd16(buffer.word_ptr++, co->ospf.hello_interval);
+      t_key8(buffer.byte_ptr++, ospf_options);
+      t_rnd8(buffer.byte_ptr++, co->ospf.hello_priority);
+      t_rnd32(buffer.dword_ptr++, co->ospf.hello_dead);
+      t_addr(buffer.inaddr_ptr++, co->ospf.hello_design);
+      t_addr(buffer.inaddr_ptr++, co->ospf.hello_backup);
 
       length += OSPF_TLEN_HELLO;
 
       /* Dealing with neighbor address(es). */
       for (counter = 0; counter < co->ospf.neighbor; counter++)
-        *buffer.inaddr_ptr++ = INADDR_RND(co->ospf.address[counter]);
+        t_addr(buffer.inaddr_ptr++, co->ospf.address[counter]);
 
       length += OSPF_TLEN_NEIGHBOR(co->ospf.neighbor);
       break;
@@ -225,10 +231,10 @@ void ospf(const struct config_options * const __restrict__ co, size_t *size)
        *  |                                                               |
        *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
        */
-      *buffer.word_ptr++ = htons(__RND(co->ospf.dd_mtu));
-      *buffer.byte_ptr++ = ospf_options;
-      *buffer.byte_ptr++ = __RND(co->ospf.dd_dbdesc);
-      *buffer.dword_ptr++ = htonl(__RND(co->ospf.dd_sequence));
+      t_rnd16(buffer.word_ptr++, co->ospf.dd_mtu);
+      t_key8(buffer.byte_ptr++, ospf_options);
+      t_rnd8(buffer.byte_ptr++, co->ospf.dd_dbdesc);
+      t_rnd32(buffer.dword_ptr++, co->ospf.dd_sequence);
 
       length += OSPF_TLEN_DD;
       break;
@@ -250,8 +256,8 @@ void ospf(const struct config_options * const __restrict__ co, size_t *size)
        *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
        */
       *buffer.dword_ptr++ = htonl(co->ospf.lsa_type);
-      *buffer.dword_ptr++ = htonl(__RND(co->ospf.lsa_lsid));
-      *buffer.inaddr_ptr++ = INADDR_RND(co->ospf.lsa_router);
+      t_rnd32(buffer.dword_ptr++, co->ospf.lsa_lsid);
+      t_addr(buffer.inaddr_ptr++, co->ospf.lsa_router);
 
       length += OSPF_TLEN_LSREQUEST;
       break;
@@ -302,21 +308,19 @@ build_ospf_lsupdate:
          *  |     Type      |     # TOS     |            metric             |
          *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
          */
-        *buffer.byte_ptr++ = __RND(co->ospf.lsa_flags);
+        t_rnd8(buffer.byte_ptr++, co->ospf.lsa_flags);
         *buffer.byte_ptr++ = FIELD_MUST_BE_ZERO;
         *buffer.word_ptr++ = htons(1);
-        *buffer.inaddr_ptr++ = INADDR_RND(co->ospf.lsa_link_id);
-        *buffer.inaddr_ptr++ = NETMASK_RND(co->ospf.lsa_link_data);
-        *buffer.byte_ptr++ = __RND(co->ospf.lsa_link_type);
+        t_addr(buffer.inaddr_ptr++, co->ospf.lsa_link_id);
+        t_netmask(buffer.inaddr_ptr++, co->ospf.lsa_link_data);
+        t_rnd8(buffer.byte_ptr++, co->ospf.lsa_link_type);
         *buffer.byte_ptr++ = FIELD_MUST_BE_ZERO;
-        *buffer.word_ptr++ = htons(__RND(co->ospf.lsa_metric));
+        t_rnd16(buffer.word_ptr++, co->ospf.lsa_metric);
 
         length += OSPF_TLEN_LSUPDATE + LSA_TLEN_ROUTER;
 
         /* Computing the checksum. */
-        ospf_lsa->check      =  co->bogus_csum ?
-          RANDOM() :
-          cksum(ospf_lsa, OSPF_TLEN_LSUPDATE + LSA_TLEN_ROUTER);
+        t_cksum(&ospf_lsa->check, ospf_lsa, OSPF_TLEN_LSUPDATE + LSA_TLEN_ROUTER, co->bogus_csum);
       }
       else if (co->ospf.lsa_type == LSA_TYPE_NETWORK)
       {
@@ -337,15 +341,13 @@ build_ospf_lsupdate:
          *  |                        Attached Router                        |
          *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
          */
-        *buffer.inaddr_ptr++ = NETMASK_RND(co->ospf.netmask);
-        *buffer.inaddr_ptr++ = INADDR_RND(co->ospf.lsa_attached);
+        t_netmask(buffer.inaddr_ptr++, co->ospf.netmask);
+        t_addr(buffer.inaddr_ptr++, co->ospf.lsa_attached);
 
         length += OSPF_TLEN_LSUPDATE + LSA_TLEN_NETWORK;
 
         /* Computing the checksum. */
-        ospf_lsa->check      =  co->bogus_csum  ?
-          RANDOM() :
-          cksum(ospf_lsa, OSPF_TLEN_LSUPDATE + LSA_TLEN_NETWORK);
+        t_cksum(&ospf_lsa->check, ospf_lsa, OSPF_TLEN_LSUPDATE + LSA_TLEN_NETWORK, co->bogus_csum);
       }
       else if (co->ospf.lsa_type == LSA_TYPE_SUMMARY_IP ||
           co->ospf.lsa_type == LSA_TYPE_SUMMARY_AS)
@@ -367,17 +369,15 @@ build_ospf_lsupdate:
          *  |      0        |                  metric                       |
          *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
          */
-        *buffer.inaddr_ptr++ = NETMASK_RND(co->ospf.netmask);
+        t_netmask(buffer.inaddr_ptr++, co->ospf.netmask);
         *buffer.byte_ptr++ = FIELD_MUST_BE_ZERO;
-        *buffer.dword_ptr++ = htonl(__RND(co->ospf.lsa_metric) << 8);
+        t_rnd24(buffer.dword_ptr++, co->ospf.lsa_metric);
         buffer.ptr--;
 
         length += OSPF_TLEN_LSUPDATE + LSA_TLEN_SUMMARY;
 
         /* Computing the checksum. */
-        ospf_lsa->check =  co->bogus_csum ?
-          RANDOM() :
-          cksum(ospf_lsa, OSPF_TLEN_LSUPDATE + LSA_TLEN_SUMMARY);
+        t_cksum(&ospf_lsa->check, ospf_lsa, OSPF_TLEN_LSUPDATE + LSA_TLEN_SUMMARY, co->bogus_csum);
       }
       else if (co->ospf.lsa_type == LSA_TYPE_ASBR ||
           co->ospf.lsa_type == LSA_TYPE_NSSA)
@@ -407,19 +407,17 @@ build_ospf_lsupdate:
          *  |                      External Route Tag                       |
          *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
          */
-        *buffer.inaddr_ptr++ = NETMASK_RND(co->ospf.netmask);
+        t_netmask(buffer.inaddr_ptr++, co->ospf.netmask);
         *buffer.byte_ptr++ = (co->ospf.lsa_larger ? 0x80 : 0);
-        *buffer.dword_ptr++ = htonl(__RND(co->ospf.lsa_metric) << 8);
+        t_rnd24(buffer.dword_ptr++, co->ospf.lsa_metric);
         buffer.ptr--;
-        *buffer.inaddr_ptr++ = INADDR_RND(co->ospf.lsa_forward);
-        *buffer.dword_ptr++ = htonl(__RND(co->ospf.lsa_external));
+        t_addr(buffer.inaddr_ptr++, co->ospf.lsa_forward);
+        t_rnd32(buffer.dword_ptr++, co->ospf.lsa_external);
 
         length += OSPF_TLEN_LSUPDATE + LSA_TLEN_ASBR;
 
         /* Computing the checksum. */
-        ospf_lsa->check      =  co->bogus_csum ?
-          RANDOM() :
-          cksum(ospf_lsa, OSPF_TLEN_LSUPDATE + LSA_TLEN_ASBR);
+        t_cksum(&ospf_lsa->check, ospf_lsa, OSPF_TLEN_LSUPDATE + LSA_TLEN_ASBR, co->bogus_csum);
       }
       else if (co->ospf.lsa_type == LSA_TYPE_MULTICAST)
       {
@@ -440,15 +438,13 @@ build_ospf_lsupdate:
          *  |                         Vertex ID                             |
          *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
          */
-        *buffer.dword_ptr++ = htonl(__RND(co->ospf.vertex_type));
-        *buffer.inaddr_ptr++ = INADDR_RND(co->ospf.vertex_id);
+        t_rnd32(buffer.dword_ptr++, co->ospf.vertex_type);
+        t_addr(buffer.inaddr_ptr++, co->ospf.vertex_id);
 
         length += OSPF_TLEN_LSUPDATE + LSA_TLEN_MULTICAST;
 
         /* Computing the checksum. */
-        ospf_lsa->check      =  co->bogus_csum ?
-          RANDOM() :
-          cksum(ospf_lsa, OSPF_TLEN_LSUPDATE + LSA_TLEN_MULTICAST);
+        t_cksum(&ospf_lsa->check, ospf_lsa, OSPF_TLEN_LSUPDATE + LSA_TLEN_MULTICAST, co->bogus_csum);
         /* Building a generic OSPF LSA Header. */
       }
       else
@@ -461,9 +457,7 @@ build_ospf_lsupdate:
         length += OSPF_TLEN_LSUPDATE + LSA_TLEN_GENERIC(0);
 
         /* Computing the checksum. */
-        ospf_lsa->check      =  co->bogus_csum ?
-          RANDOM() :
-          cksum(ospf_lsa, OSPF_TLEN_LSUPDATE + LSA_TLEN_GENERIC(0));
+        t_cksum(&ospf_lsa->check, ospf_lsa, OSPF_TLEN_LSUPDATE + LSA_TLEN_GENERIC(0), co->bogus_csum);
       }
       break;
 
@@ -509,15 +503,21 @@ build_ospf_lsupdate:
       /* OSPF LSA Header structure making a pointer to Checksum. */
 build_ospf_lsa:
       ospf_lsa             = (struct ospf_lsa_hdr *)buffer.ptr;
-      ospf_lsa->age        = htons(__RND(co->ospf.lsa_age));
+      t_rnd16(&ospf_lsa->age, co->ospf.lsa_age);
       /* Deciding whether age or not. */
       if (co->ospf.lsa_dage)
+      {
         ospf_lsa->age     |= 0x80;
+
+        /* NOTE: Templates don't keep bits over random fields. */
+        if (!co->ospf.lsa_age)
+          TEMPLATE_INVALID();
+      }
       ospf_lsa->type       = co->ospf.lsa_type;
-      ospf_lsa->options    = ospf_options;
-      ospf_lsa->lsid       = INADDR_RND(co->ospf.lsa_lsid);
-      ospf_lsa->router     = INADDR_RND(co->ospf.lsa_router);
-      ospf_lsa->sequence   = htonl(__RND(co->ospf.lsa_sequence));
+      t_key8(&ospf_lsa->options, ospf_options);
+      t_addr(&ospf_lsa->lsid, co->ospf.lsa_lsid);
+      t_addr(&ospf_lsa->router, co->ospf.lsa_router);
+      t_rnd32(&ospf_lsa->sequence, co->ospf.lsa_sequence);
       ospf_lsa->check      = 0;
 
       buffer.ptr += sizeof(struct ospf_lsa_hdr);
@@ -560,9 +560,7 @@ build_ospf_lsa:
       length += LSA_TLEN_GENERIC(0);
 
       /* Computing the checksum. */
-      ospf_lsa->check      =  co->bogus_csum ?
-        RANDOM() :
-        cksum(ospf_lsa, LSA_TLEN_GENERIC(0));
+      t_cksum(&ospf_lsa->check, ospf_lsa, LSA_TLEN_GENERIC(0), co->bogus_csum);
     }
   }
 
@@ -570,8 +568,8 @@ build_ospf_lsa:
    * The Authentication key uses HMAC-MD5 or HMAC-SHA-1 digest.
    */
   stemp = auth_hmac_md5_len(co->ospf.auth);
-  for (counter = 0; counter < stemp; counter++)
-    *buffer.byte_ptr++ = RANDOM();
+  t_bytes(buffer.ptr, stemp);
+  buffer.ptr += stemp;
 
   length += stemp;
 
@@ -654,14 +652,14 @@ build_ospf_lsa:
          */
         *buffer.word_ptr++ = htons(OSPF_TLV_CRYPTO);
         *buffer.word_ptr++ = htons(OSPF_LEN_CRYPTO);
-        *buffer.dword_ptr++ = htonl(__RND(co->ospf.sequence));
+        t_rnd32(buffer.dword_ptr++, co->ospf.sequence);
 
         /*
          * The Authentication key uses HMAC-MD5 or HMAC-SHA-1 digest.
          */
         stemp = auth_hmac_md5_len(co->ospf.auth);
-        for (counter = 0; counter < stemp; counter++)
-          *buffer.byte_ptr++ = RANDOM();
+        t_bytes(buffer.ptr, stemp);
+        buffer.ptr += stemp;
 
         /*
          * OSPF Link-Local Signaling (RFC 5613)
@@ -677,9 +675,7 @@ build_ospf_lsa:
       else
       {
         /* Computing the checksum. */
-        ospf_lls->check  =  co->bogus_csum ?
-          RANDOM() :
-          cksum(ospf_lls, ospf_tlv_len(co->ospf.type, lls, co->ospf.auth));
+        t_cksum(&ospf_lls->check, ospf_lls, ospf_tlv_len(co->ospf.type, lls, co->ospf.auth), co->bogus_csum);
       }
 
       length += ospf_tlv_len(co->ospf.type, lls, co->ospf.auth);
@@ -696,9 +692,7 @@ build_ospf_lsa:
    */
   if (!co->ospf.auth)
     /* Computing the checksum. */
-    ospf->check   = co->bogus_csum ?
-      RANDOM() :
-      cksum(ospf, sizeof(struct ospf_hdr) + length);
+    t_cksum(&ospf->check, ospf, sizeof(struct ospf_hdr) + length, co->bogus_csum);
 
   gre_checksum(packet, co, *size);
 }
@@ -771,3 +765,13 @@ static size_t ospf_hdr_len(const uint8_t foo, const uint8_t bar, const uint8_t b
 
   return size;
 }
+
+/* Function Name: OSPF template layout.
+
+Description:   The LLS bit of the drawn options adds the LLS block (see t_key()).
+
+Targets:       N/A */
+static unsigned ospf_variant(uint32_t options)
+{
+  return TEST_BITS((uint8_t)options, OSPF_OPTION_LLS) ? 1 : 0;
+}
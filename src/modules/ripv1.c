@@ -28,8 +28,7 @@ Description:   This function configures and sends the RIPv1 packet header.
 Targets:       N/A */
 void ripv1(const struct config_options *const co, size_t *size)
 {
-  size_t greoptlen,   /* GRE options size. */
-         length;
+  size_t greoptlen;   /* GRE options size. */
 
   mptr_t buffer;
 
@@ -38,18 +37,18 @@ void ripv1(const struct config_options *const co, size_t *size)
   /* GRE Encapsulated IP Header. */
   struct iphdr * gre_ip;
 
-  /* UDP header and PSEUDO header. */
+  /* UDP header. */
   struct udphdr * udp;
-  struct psdhdr * pseudo;
 
   assert(co != NULL);
 
+  TEMPLATE_SUPPORTED();
+
   greoptlen = gre_opt_len(co->gre.options, co->encapsulated);
   *size = sizeof(struct iphdr)  +
           greoptlen             +
           sizeof(struct udphdr) +
-          rip_hdr_len(0)        +
-          sizeof(struct psdhdr);
+          rip_hdr_len(0);
 
   /* Try to reallocate packet, if necessary */
   alloc_packet(*size);
@@ -97,27 +96,18 @@ void ripv1(const struct config_options *const co, size_t *size)
   *buffer.byte_ptr++ = RIPVERSION;
   *buffer.word_ptr++ = FIELD_MUST_BE_ZERO;
 
-  *buffer.word_ptr++ = htons(__RND(co->rip.family));
+  t_rnd16(buffer.word_ptr++, co->rip.family);
   *buffer.word_ptr++ = FIELD_MUST_BE_ZERO;
-  *buffer.inaddr_ptr++ = INADDR_RND(co->rip.address);
+  t_addr(buffer.inaddr_ptr++, co->rip.address);
   *buffer.inaddr_ptr++ = FIELD_MUST_BE_ZERO;
   *buffer.inaddr_ptr++ = FIELD_MUST_BE_ZERO;
-  *buffer.inaddr_ptr++ = htonl(__RND(co->rip.metric));
+  t_rnd32(buffer.inaddr_ptr++, co->rip.metric);
 
   /* DON'T NEED THIS */
   /* length += RIP_HEADER_LENGTH + RIP_MESSAGE_LENGTH; */
 
-  /* PSEUDO Header structure making a pointer to Checksum. */
-  pseudo           = (struct psdhdr *)buffer.ptr;
-  pseudo->saddr    = co->encapsulated ? gre_ip->saddr : ip->saddr;
-  pseudo->daddr    = co->encapsulated ? gre_ip->daddr : ip->daddr;
-  pseudo->zero     = 0;
-  pseudo->protocol = co->ip.protocol;
-  pseudo->len      = htons(length = buffer.ptr - (void *)udp);
-
   /* Computing the checksum. */
-  udp->check  = co->bogus_csum ? RANDOM() : 
-    cksum(udp, buffer.ptr - (void *)udp + sizeof(struct psdhdr));
+  t_cksum_psd(&udp->check, udp, buffer.ptr - (void *)udp, co->encapsulated ? gre_ip : ip, co);
 
   /* GRE Encapsulation takes place. */
   gre_checksum(packet, co, *size);
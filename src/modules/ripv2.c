@@ -29,8 +29,7 @@ Targets:       N/A */
 void ripv2(const struct config_options * const __restrict__ co, size_t *size)
 {
   size_t greoptlen,     /* GRE options size. */
-         length,
-         counter;
+         length;
 
   mptr_t buffer;
 
@@ -39,18 +38,18 @@ void ripv2(const struct config_options * const __restrict__ co, size_t *size)
   /* GRE Encapsulated IP Header. */
   struct iphdr * gre_ip;
 
-  /* UDP header and PSEUDO header. */
+  /* UDP header. */
   struct udphdr * udp;
-  struct psdhdr * pseudo;
 
   assert(co != NULL);
 
+  TEMPLATE_SUPPORTED();
+
   greoptlen = gre_opt_len(co->gre.options, co->encapsulated);
   *size = sizeof(struct iphdr)  +
           greoptlen             +
           sizeof(struct udphdr) +
-          rip_hdr_len(co->rip.auth) +
-          sizeof(struct psdhdr);
+          rip_hdr_len(co->rip.auth);
 
   /* Try to reallocate packet, if necessary */
   alloc_packet(*size);
@@ -107,7 +106,7 @@ void ripv2(const struct config_options * const __restrict__ co, size_t *size)
    */
   *buffer.byte_ptr++ = co->rip.command;
   *buffer.byte_ptr++ = RIPVERSION;
-  *buffer.word_ptr++ = htons(__RND(co->rip.domain));
+  t_rnd16(buffer.word_ptr++, co->rip.domain);
 
   /* DON'T NEED THIS */
   /* length = sizeof(struct udphdr) + RIP_HEADER_LENGTH; */
@@ -163,7 +162,7 @@ void ripv2(const struct config_options * const __restrict__ co, size_t *size)
         RIP_AUTH_LENGTH + RIP_MESSAGE_LENGTH);
     *buffer.byte_ptr++ = co->rip.key_id;
     *buffer.byte_ptr++ = RIP_AUTH_LENGTH;
-    *buffer.dword_ptr++ = htonl(__RND(co->rip.sequence));
+    t_rnd32(buffer.dword_ptr++, co->rip.sequence);
     *buffer.dword_ptr++ = FIELD_MUST_BE_ZERO;
     *buffer.dword_ptr++ = FIELD_MUST_BE_ZERO;
 
@@ -200,12 +199,12 @@ void ripv2(const struct config_options * const __restrict__ co, size_t *size)
    *   |                                                               |
    *   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
    */
-  *buffer.word_ptr++ = htons(__RND(co->rip.family));
-  *buffer.word_ptr++ = htons(__RND(co->rip.tag));
-  *buffer.inaddr_ptr++ = INADDR_RND(co->rip.address);
-  *buffer.inaddr_ptr++ = NETMASK_RND(htonl(co->rip.netmask));
-  *buffer.inaddr_ptr++ = INADDR_RND(co->rip.next_hop);
-  *buffer.inaddr_ptr++ = htonl(__RND(co->rip.metric));
+  t_rnd16(buffer.word_ptr++, co->rip.family);
+  t_rnd16(buffer.word_ptr++, co->rip.tag);
+  t_addr(buffer.inaddr_ptr++, co->rip.address);
+  t_netmask(buffer.inaddr_ptr++, htonl(co->rip.netmask));
+  t_addr(buffer.inaddr_ptr++, co->rip.next_hop);
+  t_rnd32(buffer.inaddr_ptr++, co->rip.metric);
 
   /* DON'T NEED THIS */
   /* length += RIP_MESSAGE_LENGTH; */
@@ -234,30 +233,22 @@ void ripv2(const struct config_options * const __restrict__ co, size_t *size)
      * The Authentication key uses HMAC-MD5 or HMAC-SHA-1 digest.
      */
     size = auth_hmac_md5_len(co->rip.auth);
-    for (counter = 0; counter < size; counter++)
-      *buffer.byte_ptr++ = RANDOM();
+    t_bytes(buffer.ptr, size);
+    buffer.ptr += size;
 
     /* DON'T NEED THIS */
     /* length += RIP_TRAILER_LENGTH + size; */
   }
 
-  /* PSEUDO Header structure making a pointer to Checksum. */
-  pseudo           = (struct psdhdr *)buffer.ptr;
-  pseudo->saddr    = co->encapsulated ? gre_ip->saddr : ip->saddr;
-  pseudo->daddr    = co->encapsulated ? gre_ip->daddr : ip->daddr;
-  pseudo->zero     = 0;
-  pseudo->protocol = co->ip.protocol;
-  pseudo->len      = htons(length = buffer.ptr - (void *)udp);
-
-  /* FIX: buffer.ptr points to 'pseudo' So, it is simple to calculate the size used
-          by cksum() function.
+  /* FIX: buffer.ptr points to the end of the packet. So, it is simple to
+          calculate the size used by cksum() function.
 
           This is easier than accumulate the "length" through
           various conditionals above! */
+  length = buffer.ptr - (void *)udp;
 
   /* Computing the checksum. */
-  udp->check  = co->bogus_csum ? RANDOM() : 
-    cksum(udp, length + sizeof(struct psdhdr));
+  t_cksum_psd(&udp->check, udp, length, co->encapsulated ? gre_ip : ip, co);
 
   /* GRE Encapsulation takes place. */
   gre_checksum(packet, co, *size);
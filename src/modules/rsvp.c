@@ -44,6 +44,8 @@ void rsvp(const struct config_options * const __restrict__ co, size_t *size)
 
   assert(co != NULL);
 
+  TEMPLATE_SUPPORTED();
+
   greoptlen = gre_opt_len(co->gre.options, co->encapsulated);
   objects_length = rsvp_objects_len(co->rsvp.type, co->rsvp.scope, co->rsvp.adspec, co->rsvp.tspec);
   *size = sizeof(struct iphdr)           +
@@ -65,13 +67,12 @@ void rsvp(const struct config_options * const __restrict__ co, size_t *size)
 
   /* RSVP Header structure making a pointer to IP Header structure. */
   rsvp           = (struct rsvp_common_hdr *)((void *)ip + sizeof(struct iphdr) + greoptlen);
-  rsvp->flags    = __RND(co->rsvp.flags);
+  t_bitfield(rsvp, flags, co->rsvp.flags);
   rsvp->version  = RSVPVERSION;
   rsvp->type     = co->rsvp.type;
-  rsvp->ttl      = __RND(co->rsvp.ttl);
+  t_rnd8(&rsvp->ttl, co->rsvp.ttl);
   rsvp->length   = htons(sizeof(struct rsvp_common_hdr) + objects_length);
   rsvp->reserved = FIELD_MUST_BE_ZERO;
-  rsvp->check    = 0;
 
   buffer.ptr = (void *)rsvp + sizeof(struct rsvp_common_hdr);
 
@@ -95,10 +96,10 @@ void rsvp(const struct config_options * const __restrict__ co, size_t *size)
   *buffer.word_ptr++ = htons(RSVP_LENGTH_SESSION);
   *buffer.byte_ptr++ = RSVP_OBJECT_SESSION;
   *buffer.byte_ptr++ = 1;
-  *buffer.inaddr_ptr++ = INADDR_RND(co->rsvp.session_addr);
-  *buffer.byte_ptr++ = __RND(co->rsvp.session_proto);
-  *buffer.byte_ptr++ = __RND(co->rsvp.session_flags);
-  *buffer.word_ptr++ = htons(__RND(co->rsvp.session_port));
+  t_addr(buffer.inaddr_ptr++, co->rsvp.session_addr);
+  t_rnd8(buffer.byte_ptr++, co->rsvp.session_proto);
+  t_rnd8(buffer.byte_ptr++, co->rsvp.session_flags);
+  t_rnd16(buffer.word_ptr++, co->rsvp.session_port);
 
   /* DON'T NEED THIS! */
   /* length = sizeof(struct rsvp_common_hdr) + RSVP_LENGTH_SESSION; */
@@ -135,8 +136,8 @@ void rsvp(const struct config_options * const __restrict__ co, size_t *size)
     *buffer.word_ptr++ = htons(RSVP_LENGTH_RESV_HOP);
     *buffer.byte_ptr++ = RSVP_OBJECT_RESV_HOP;
     *buffer.byte_ptr++ = 1;
-    *buffer.inaddr_ptr++ = INADDR_RND(co->rsvp.hop_addr);
-    *buffer.dword_ptr++ = htonl(__RND(co->rsvp.hop_iface));
+    t_addr(buffer.inaddr_ptr++, co->rsvp.hop_addr);
+    t_rnd32(buffer.dword_ptr++, co->rsvp.hop_iface);
 
     /* DON'T NEED THIS! */
     /* length += RSVP_LENGTH_RESV_HOP; */
@@ -166,7 +167,7 @@ void rsvp(const struct config_options * const __restrict__ co, size_t *size)
     *buffer.word_ptr++ = htons(RSVP_LENGTH_TIME_VALUES);
     *buffer.byte_ptr++ = RSVP_OBJECT_TIME_VALUES;
     *buffer.byte_ptr++ = 1;
-    *buffer.dword_ptr++ = htonl(__RND(co->rsvp.time_refresh));
+    t_rnd32(buffer.dword_ptr++, co->rsvp.time_refresh);
 
     /* DON'T NEED THIS! */
     /* length += RSVP_LENGTH_TIME_VALUES; */
@@ -200,10 +201,10 @@ void rsvp(const struct config_options * const __restrict__ co, size_t *size)
     *buffer.word_ptr++ = htons(RSVP_LENGTH_ERROR_SPEC);
     *buffer.byte_ptr++ = RSVP_OBJECT_ERROR_SPEC;
     *buffer.byte_ptr++ = 1;
-    *buffer.inaddr_ptr++ = INADDR_RND(co->rsvp.error_addr);
-    *buffer.byte_ptr++ = __RND(co->rsvp.error_flags);
-    *buffer.byte_ptr++ = __RND(co->rsvp.error_code);
-    *buffer.word_ptr++ = htons(__RND(co->rsvp.error_value));
+    t_addr(buffer.inaddr_ptr++, co->rsvp.error_addr);
+    t_rnd8(buffer.byte_ptr++, co->rsvp.error_flags);
+    t_rnd8(buffer.byte_ptr++, co->rsvp.error_code);
+    t_rnd16(buffer.word_ptr++, co->rsvp.error_value);
 
     /* DON'T NEED THIS! */
     /* length += RSVP_LENGTH_ERROR_SPEC; */
@@ -244,9 +245,9 @@ void rsvp(const struct config_options * const __restrict__ co, size_t *size)
     *buffer.word_ptr++ = htons(RSVP_LENGTH_SENDER_TEMPLATE);
     *buffer.byte_ptr++ = RSVP_OBJECT_SENDER_TEMPLATE;
     *buffer.byte_ptr++ = 1;
-    *buffer.inaddr_ptr++ = INADDR_RND(co->rsvp.sender_addr);
+    t_addr(buffer.inaddr_ptr++, co->rsvp.sender_addr);
     *buffer.word_ptr++ = FIELD_MUST_BE_ZERO;
-    *buffer.word_ptr++ = htons(__RND(co->rsvp.sender_port));
+    t_rnd16(buffer.word_ptr++, co->rsvp.sender_port);
 
     /* DON'T NEED THIS! */
     /* length += RSVP_LENGTH_SENDER_TEMPLATE; */
@@ -308,11 +309,11 @@ void rsvp(const struct config_options * const __restrict__ co, size_t *size)
         *buffer.byte_ptr++ = FIELD_MUST_BE_ZERO;
         *buffer.word_ptr++ = htons((TSPEC_SERVICES(co->rsvp.tspec) -
               TSPEC_MESSAGE_HEADER)/4);
-        *buffer.dword_ptr++ = htonl(__RND(co->rsvp.tspec_r));
-        *buffer.dword_ptr++ = htonl(__RND(co->rsvp.tspec_b));
-        *buffer.dword_ptr++ = htonl(__RND(co->rsvp.tspec_p));
-        *buffer.dword_ptr++ = htonl(__RND(co->rsvp.tspec_m));
-        *buffer.dword_ptr++ = htonl(__RND(co->rsvp.tspec_M));
+        t_rnd32(buffer.dword_ptr++, co->rsvp.tspec_r);
+        t_rnd32(buffer.dword_ptr++, co->rsvp.tspec_b);
+        t_rnd32(buffer.dword_ptr++, co->rsvp.tspec_p);
+        t_rnd32(buffer.dword_ptr++, co->rsvp.tspec_m);
+        t_rnd32(buffer.dword_ptr++, co->rsvp.tspec_M);
         break;
     }
 
@@ -400,19 +401,19 @@ void rsvp(const struct config_options * const __restrict__ co, size_t *size)
     *buffer.byte_ptr++ = ADSPEC_PARAMETER_ISHOPCNT;
     *buffer.byte_ptr++ = FIELD_MUST_BE_ZERO;
     *buffer.word_ptr++ = htons(ADSPEC_SERVDATA_HEADER/4);
-    *buffer.dword_ptr++ = htonl(__RND(co->rsvp.adspec_hop));
+    t_rnd32(buffer.dword_ptr++, co->rsvp.adspec_hop);
     *buffer.byte_ptr++ = ADSPEC_PARAMETER_BANDWIDTH;
     *buffer.byte_ptr++ = FIELD_MUST_BE_ZERO;
     *buffer.word_ptr++ = htons(ADSPEC_SERVDATA_HEADER/4);
-    *buffer.dword_ptr++ = htonl(__RND(co->rsvp.adspec_path));
+    t_rnd32(buffer.dword_ptr++, co->rsvp.adspec_path);
     *buffer.byte_ptr++ = ADSPEC_PARAMETER_LATENCY;
     *buffer.byte_ptr++ = FIELD_MUST_BE_ZERO;
     *buffer.word_ptr++ = htons(ADSPEC_SERVDATA_HEADER/4);
-    *buffer.dword_ptr++ = htonl(__RND(co->rsvp.adspec_minimum));
+    t_rnd32(buffer.dword_ptr++, co->rsvp.adspec_minimum);
     *buffer.byte_ptr++ = ADSPEC_PARAMETER_COMPMTU;
     *buffer.byte_ptr++ = FIELD_MUST_BE_ZERO;
     *buffer.word_ptr++ = htons(ADSPEC_SERVDATA_HEADER/4);
-    *buffer.dword_ptr++ = htonl(__RND(co->rsvp.adspec_mtu));
+    t_rnd32(buffer.dword_ptr++, co->rsvp.adspec_mtu);
 
     /* DON'T NEED THIS! */
     /* length += ADSPEC_PARAMETER_LENGTH; */
@@ -459,19 +460,19 @@ void rsvp(const struct config_options * const __restrict__ co, size_t *size)
         *buffer.byte_ptr++ = 133;
         *buffer.byte_ptr++ = FIELD_MUST_BE_ZERO;
         *buffer.word_ptr++ = htons(ADSPEC_SERVDATA_HEADER/4);
-        *buffer.dword_ptr++ = htonl(__RND(co->rsvp.adspec_Ctot));
+        t_rnd32(buffer.dword_ptr++, co->rsvp.adspec_Ctot);
         *buffer.byte_ptr++ = 134;
         *buffer.byte_ptr++ = FIELD_MUST_BE_ZERO;
         *buffer.word_ptr++ = htons(ADSPEC_SERVDATA_HEADER/4);
-        *buffer.dword_ptr++ = htonl(__RND(co->rsvp.adspec_Dtot));
+        t_rnd32(buffer.dword_ptr++, co->rsvp.adspec_Dtot);
         *buffer.byte_ptr++ = 135;
         *buffer.byte_ptr++ = FIELD_MUST_BE_ZERO;
         *buffer.word_ptr++ = htons(ADSPEC_SERVDATA_HEADER/4);
-        *buffer.dword_ptr++ = htonl(__RND(co->rsvp.adspec_Csum));
+        t_rnd32(buffer.dword_ptr++, co->rsvp.adspec_Csum);
         *buffer.byte_ptr++ = 136;
         *buffer.byte_ptr++ = FIELD_MUST_BE_ZERO;
         *buffer.word_ptr++ = htons(ADSPEC_SERVDATA_HEADER/4);
-        *buffer.dword_ptr++ = htonl(__RND(co->rsvp.adspec_Dsum));
+        t_rnd32(buffer.dword_ptr++, co->rsvp.adspec_Dsum);
 
         /* DON'T NEED THIS! */
         /* length += ADSPEC_GUARANTEED_LENGTH; */
@@ -529,7 +530,7 @@ void rsvp(const struct config_options * const __restrict__ co, size_t *size)
     *buffer.word_ptr++ = htons(RSVP_LENGTH_RESV_CONFIRM);
     *buffer.byte_ptr++ = RSVP_OBJECT_RESV_CONFIRM;
     *buffer.byte_ptr++ = 1;
-    *buffer.inaddr_ptr++ = INADDR_RND(co->rsvp.confirm_addr);
+    t_addr(buffer.inaddr_ptr++, co->rsvp.confirm_addr);
 
     /* DON'T NEED THIS! */
     /* length += RSVP_LENGTH_RESV_CONFIRM; */
@@ -580,7 +581,7 @@ void rsvp(const struct config_options * const __restrict__ co, size_t *size)
 
       /* Dealing with scope address(es). */
       for(counter = 0; counter < co->rsvp.scope ; counter ++)
-        *buffer.inaddr_ptr++ = INADDR_RND(co->rsvp.address[counter]);
+        t_addr(buffer.inaddr_ptr++, co->rsvp.address[counter]);
 
       /* DON'T NEED THIS! */
       /* length += RSVP_LENGTH_SCOPE(co->rsvp.scope); */
@@ -602,7 +603,7 @@ void rsvp(const struct config_options * const __restrict__ co, size_t *size)
     *buffer.byte_ptr++ = RSVP_OBJECT_STYLE;
     *buffer.byte_ptr++ = 1;
     *buffer.byte_ptr++ = FIELD_MUST_BE_ZERO;
-    *buffer.dword_ptr++ = htonl(__RND(co->rsvp.style_opt) << 8);
+    t_rnd24(buffer.dword_ptr++, co->rsvp.style_opt);
 
     /* DON'T NEED THIS! */
     /* length += RSVP_LENGTH_STYLE; */
@@ -616,9 +617,7 @@ void rsvp(const struct config_options * const __restrict__ co, size_t *size)
           various conditionals above! */
 
   /* Computing the checksum. */
-  rsvp->check   = co->bogus_csum ?
-    RANDOM() :
-    cksum(rsvp, buffer.ptr - (void *)rsvp);
+  t_cksum(&rsvp->check, rsvp, buffer.ptr - (void *)rsvp, co->bogus_csum);
 
   /* GRE Encapsulation takes place. */
   gre_checksum(packet, co, *size);
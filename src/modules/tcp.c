@@ -34,8 +34,7 @@ void tcp(const struct config_options * const __restrict__ co, size_t *size)
   size_t greoptlen,   /* GRE options size. */
          tcpolen,     /* TCP options size. */
          tcpopt,      /* TCP options total size. */
-         length,
-         counter;
+         length;
 
   mptr_t buffer;
 
@@ -44,20 +43,20 @@ void tcp(const struct config_options * const __restrict__ co, size_t *size)
   /* GRE Encapsulated IP Header. */
   struct iphdr *gre_ip;
 
-  /* TCP header and PSEUDO header. */
+  /* TCP header. */
   struct tcphdr *tcp;
-  struct psdhdr *pseudo;
 
   assert(co != NULL);
 
+  TEMPLATE_SUPPORTED();
+
   greoptlen = gre_opt_len(co->gre.options, co->encapsulated);
   tcpolen = tcp_options_len(co->tcp.options, co->tcp.md5, co->tcp.auth);
   tcpopt = tcpolen + TCPOLEN_PADDING(tcpolen);
   *size = sizeof(struct iphdr)  +
           greoptlen             +
           sizeof(struct tcphdr) +
-          tcpopt                +
-          sizeof(struct psdhdr);
+          tcpopt;
 
   /* Try to reallocate packet, if necessary */
   alloc_packet(*size);
@@ -87,22 +86,31 @@ void tcp(const struct config_options * const __restrict__ co, size_t *size)
 
   /* TCP Header structure making a pointer to IP Header structure. */
   tcp          = (struct tcphdr *)((void *)ip + sizeof(struct iphdr) + greoptlen);
-  tcp->source  = htons(IPPORT_RND(co->source));
-  tcp->dest    = htons(IPPORT_RND(co->dest));
+  t_sport(&tcp->source, co);
+  t_dport(&tcp->dest, co);
   tcp->res1    = TCP_RESERVED_BITS;
   tcp->doff    = co->tcp.doff ? co->tcp.doff : ((sizeof(struct tcphdr) + tcpopt) / 4);
   tcp->fin     = co->tcp.fin;
   tcp->syn     = co->tcp.syn;
-  tcp->seq     = co->tcp.syn ? htonl(__RND(co->tcp.sequence)) : 0;
+  if (co->tcp.syn)
+    t_rnd32(&tcp->seq, co->tcp.sequence);
+  else
+    tcp->seq   = 0;
   tcp->rst     = co->tcp.rst;
   tcp->psh     = co->tcp.psh;
   tcp->ack     = co->tcp.ack;
-  tcp->ack_seq = co->tcp.ack ? htonl(__RND(co->tcp.acknowledge)) : 0;
+  if (co->tcp.ack)
+    t_rnd32(&tcp->ack_seq, co->tcp.acknowledge);
+  else
+    tcp->ack_seq = 0;
   tcp->urg     = co->tcp.urg;
-  tcp->urg_ptr = co->tcp.urg ? htons(__RND(co->tcp.urg_ptr)) : 0;
+  if (co->tcp.urg)
+    t_rnd16(&tcp->urg_ptr, co->tcp.urg_ptr);
+  else
+    tcp->urg_ptr = 0;
   tcp->ece     = co->tcp.ece;
   tcp->cwr     = co->tcp.cwr;
-  tcp->window  = htons(__RND(co->tcp.window));
+  t_rnd16(&tcp->window, co->tcp.window);
   tcp->check   = 0; /* Needed 'cause of cksum() call */
 
   buffer.ptr = (void *)tcp + sizeof(struct tcphdr);
@@ -124,7 +132,7 @@ void tcp(const struct config_options * const __restrict__ co, size_t *size)
   {
     *buffer.byte_ptr++ = TCPOPT_MSS;
     *buffer.byte_ptr++ = TCPOLEN_MSS;
-    *buffer.word_ptr++ = htons(__RND(co->tcp.mss));
+    t_rnd16(buffer.word_ptr++, co->tcp.mss);
   }
 
   /*
@@ -144,7 +152,7 @@ void tcp(const struct config_options * const __restrict__ co, size_t *size)
   {
     *buffer.byte_ptr++ = TCPOPT_WSOPT;
     *buffer.byte_ptr++ = TCPOLEN_WSOPT;
-    *buffer.byte_ptr++ = __RND(co->tcp.wsopt);
+    t_rnd8(buffer.byte_ptr++, co->tcp.wsopt);
   }
 
   /*
@@ -189,8 +197,8 @@ void tcp(const struct config_options * const __restrict__ co, size_t *size)
         *buffer.byte_ptr++ = TCPOPT_NOP;
     *buffer.byte_ptr++ = TCPOPT_TSOPT;
     *buffer.byte_ptr++ = TCPOLEN_TSOPT;
-    *buffer.dword_ptr++ = htonl(__RND(co->tcp.tsval));
-    *buffer.dword_ptr++ = htonl(__RND(co->tcp.tsecr));
+    t_rnd32(buffer.dword_ptr++, co->tcp.tsval);
+    t_rnd32(buffer.dword_ptr++, co->tcp.tsecr);
   }
 
   /*
@@ -212,7 +220,7 @@ void tcp(const struct config_options * const __restrict__ co, size_t *size)
   {
     *buffer.byte_ptr++ = TCPOPT_CC;
     *buffer.byte_ptr++ = TCPOLEN_CC;
-    *buffer.dword_ptr++ = htonl(__RND(co->tcp.cc));
+    t_rnd32(buffer.dword_ptr++, co->tcp.cc);
 
     /*
      * TCP Extensions for Transactions Functional Specification (RFC 1644)
@@ -225,7 +233,7 @@ void tcp(const struct config_options * const __restrict__ co, size_t *size)
      *  value from the sender's TCB.
      */
     tcp->syn     = 1;
-    tcp->seq     = htonl(__RND(co->tcp.sequence));
+    t_rnd32(&tcp->seq, co->tcp.sequence);
   }
 
   /*
@@ -259,12 +267,10 @@ void tcp(const struct config_options * const __restrict__ co, size_t *size)
   {
     *buffer.byte_ptr++ = co->tcp.cc_new ? TCPOPT_CC_NEW : TCPOPT_CC_ECHO;
     *buffer.byte_ptr++ = TCPOLEN_CC;
-    *buffer.dword_ptr++ = htonl(co->tcp.cc_new ?
-        __RND(co->tcp.cc_new) : 
-        __RND(co->tcp.cc_echo));
+    t_rnd32(buffer.dword_ptr++, co->tcp.cc_new ? co->tcp.cc_new : co->tcp.cc_echo);
 
     tcp->syn = 1;
-    tcp->seq = htonl(__RND(co->tcp.sequence));
+    t_rnd32(&tcp->seq, co->tcp.sequence);
 
     /*
      * TCP Extensions for Transactions Functional Specification (RFC 1644)
@@ -290,7 +296,7 @@ void tcp(const struct config_options * const __restrict__ co, size_t *size)
        * from the initial SYN.
        */
       tcp->ack     = 1;
-      tcp->ack_seq = htonl(__RND(co->tcp.acknowledge));
+      t_rnd32(&tcp->ack_seq, co->tcp.acknowledge);
     }
   }
 
@@ -342,8 +348,8 @@ void tcp(const struct config_options * const __restrict__ co, size_t *size)
   {
     *buffer.byte_ptr++ = TCPOPT_SACK_EDGE;
     *buffer.byte_ptr++ = TCPOLEN_SACK_EDGE(1);
-    *buffer.dword_ptr++ = htonl(__RND(co->tcp.sack_left));
-    *buffer.dword_ptr++ = htonl(__RND(co->tcp.sack_right));
+    t_rnd32(buffer.dword_ptr++, co->tcp.sack_left);
+    t_rnd32(buffer.dword_ptr++, co->tcp.sack_right);
   }
 
   /*
@@ -377,8 +383,8 @@ void tcp(const struct config_options * const __restrict__ co, size_t *size)
      * The Authentication key uses HMAC-MD5 digest.
      */
     stemp = auth_hmac_md5_len(co->tcp.md5);
-    for (counter = 0; counter < stemp; counter++)
-      *buffer.byte_ptr++ = RANDOM();
+    t_bytes(buffer.ptr, stemp);
+    buffer.ptr += stemp;
   }
 
   /*
@@ -408,14 +414,14 @@ void tcp(const struct config_options * const __restrict__ co, size_t *size)
 
     *buffer.byte_ptr++ = TCPOPT_AO;
     *buffer.byte_ptr++ = TCPOLEN_AO;
-    *buffer.byte_ptr++ = __RND(co->tcp.key_id);
-    *buffer.byte_ptr++ = __RND(co->tcp.next_key);
+    t_rnd8(buffer.byte_ptr++, co->tcp.key_id);
+    t_rnd8(buffer.byte_ptr++, co->tcp.next_key);
     /*
      * The Authentication key uses HMAC-MD5 digest.
      */
     stemp = auth_hmac_md5_len(co->tcp.auth);
-    for (counter = 0; counter < stemp; counter++)
-      *buffer.byte_ptr++ = RANDOM();
+    t_bytes(buffer.ptr, stemp);
+    buffer.ptr += stemp;
   }
 
   /* Padding the TCP Options. */
@@ -424,18 +430,8 @@ void tcp(const struct config_options * const __restrict__ co, size_t *size)
 
   length = sizeof(struct tcphdr) + tcpolen;
 
-  /* Fill PSEUDO Header structure. */
-  pseudo           = (struct psdhdr *)buffer.ptr;
-  pseudo->saddr    = co->encapsulated ? gre_ip->saddr : ip->saddr;
-  pseudo->daddr    = co->encapsulated ? gre_ip->daddr : ip->daddr;
-  pseudo->zero     = 0;
-  pseudo->protocol = co->ip.protocol;
-  pseudo->len      = htons(length);
-
-  length += sizeof(struct psdhdr);
-
   /* Computing the checksum. */
-  tcp->check   = co->bogus_csum ? RANDOM() : cksum(tcp, length);
+  t_cksum_psd(&tcp->check, tcp, length, co->encapsulated ? gre_ip : ip, co);
 
   gre_checksum(packet, co, *size);
 }
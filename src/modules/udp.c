@@ -37,14 +37,15 @@ void udp(const struct config_options * const __restrict__ co, size_t *size)
   /* GRE Encapsulated IP Header. */
   struct iphdr *gre_ip;
 
-  /* UDP header and PSEUDO header. */
+  /* UDP header. */
   struct udphdr *udp;
-  struct psdhdr *pseudo;
 
   assert(co != NULL);
 
+  TEMPLATE_SUPPORTED();
+
   greoptlen = gre_opt_len(co->gre.options, co->encapsulated);
-  *size = sizeof(struct iphdr) + greoptlen + sizeof(struct udphdr) + sizeof(struct psdhdr);
+  *size = sizeof(struct iphdr) + greoptlen + sizeof(struct udphdr);
 
   /* Try to reallocate packet, if necessary */
   alloc_packet(*size);
@@ -57,26 +58,16 @@ void udp(const struct config_options * const __restrict__ co, size_t *size)
 
   /* UDP Header structure making a pointer to  IP Header structure. */
   udp         = (struct udphdr *)((void *)ip + sizeof(struct iphdr) + greoptlen);
-  udp->source = htons(IPPORT_RND(co->source));
-  udp->dest   = htons(IPPORT_RND(co->dest));
+  t_sport(&udp->source, co);
+  t_dport(&udp->dest, co);
   udp->len    = htons(sizeof(struct udphdr));
   udp->check  = 0;    /* needed 'cause of cksum(), below! */
 
-  /* Fill PSEUDO Header structure. */
-  pseudo           = (struct psdhdr *)((void *)udp + sizeof(struct udphdr));
-  pseudo->saddr    = co->encapsulated ? gre_ip->saddr : ip->saddr;
-  pseudo->daddr    = co->encapsulated ? gre_ip->daddr : ip->daddr;
-  pseudo->zero     = 0;
-  pseudo->protocol = co->ip.protocol;
-  pseudo->len      = htons(sizeof(struct udphdr));
-
   /* Computing the checksum. */
-  udp->check  = co->bogus_csum ? RANDOM() :
-    cksum(udp, sizeof(struct udphdr) + sizeof(struct psdhdr));
+  t_cksum_psd(&udp->check, udp, sizeof(struct udphdr), co->encapsulated ? gre_ip : ip, co);
 
 #ifdef DUMP_DATA
   dump_udp(fdebug, udp);
-  dump_psdhdr(fdebug, pseudo);
 #endif
 
   gre_checksum(packet, co, *size);
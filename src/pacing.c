@@ -0,0 +1,146 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <common.h>
+
+/* Gaps shorter than this are busy waited. nanosleep() wake up latency
+   (timer slack included) is around 50~100 us on a regular kernel. */
+#define SPIN_THRESHOLD_NS 100000
+
+/* Bucket depth: how much credit a late worker can use to catch up. */
+#define PACING_DEPTH_NS   1000000
+
+#if defined(__x86_64__) || defined(__i386__)
+  #define cpu_relax() __builtin_ia32_pause()
+#else
+  #define cpu_relax() {}
+#endif
+
+/* NOTE: CLOCK_MONOTONIC is read through vDSO (TSC based on x86), 
+         so there is no system call here. */
+uint64_t monotonic_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Bits a packet of 'size' bytes takes on the wire, with link layer overhead. */
+uint64_t wire_bits(size_t size, unsigned overhead)
+{
+  size_t bytes = size;
+
+  if (overhead != OVERHEAD_NONE)
+  {
+    /* Ethernet header and FCS. Frames are padded to 64 bytes. */
+    bytes += ETH_HLEN + ETH_FCS_LEN;
+    if (bytes < ETH_ZLEN + ETH_FCS_LEN)
+      bytes = ETH_ZLEN + ETH_FCS_LEN;
+
+    if (overhead == OVERHEAD_L1)
+      bytes += ETH_PREAMBLE_LEN + ETH_IFG_LEN;
+  }
+
+  return bytes * 8;
+}
+
+/* The requested rates are divided among the workers. */
+void pacer_init(struct pacer *p, const struct config_options *co, unsigned num_workers)
+{
+  assert(p != NULL);
+  assert(co != NULL);
+
+  memset(p, 0, sizeof(struct pacer));
+
+  if (co->pps > 0)
+    p->ns_per_packet = 1e9 * num_workers / co->pps;
+  if (co->bps > 0)
+    p->ns_per_bit = 1e9 * num_workers / co->bps;
+
+  p->overhead = co->overhead;
+  p->depth = PACING_DEPTH_NS;
+}
+
+/* Waits until the packet of 'size' bytes may be sent. */
+void pacer_wait(struct pacer *p, size_t size)
+{
+  uint64_t now, bits;
+  double cost, next;
+
+  bits = wire_bits(size, p->overhead);
+
+  /* Both limits apply. The most restrictive wins. */
+  cost = p->ns_per_packet;
+  if (bits * p->ns_per_bit > cost)
+    cost = bits * p->ns_per_bit;
+
+  now = monotonic_ns();
+  if (p->packets == 0)
+    p->start = p->next = now;
+
+  /* Bucket is full: don't accumulate credit beyond its depth. */
+  if (p->next < now - p->depth)
+    p->next = now - p->depth;
+
+  next = p->next;
+  if (next > now)
+  {
+    /* Long gaps sleep, but wake up early to spin the remaining time. */
+    if (next - now > SPIN_THRESHOLD_NS)
+    {
+      struct timespec ts;
+      uint64_t gap = next - now - SPIN_THRESHOLD_NS;
+
+      ts.tv_sec = gap / 1000000000ULL;
+      ts.tv_nsec = gap % 1000000000ULL;
+      nanosleep(&ts, NULL);
+    }
+
+    while ((now = monotonic_ns()) < next)
+      cpu_relax();
+  }
+
+  p->next += cost;
+  p->last = now;
+  p->packets++;
+  p->bits += bits;
+}
+
+/* Accounts the packet as if it was sent on time, without waiting.
+   Returns when it would be sent, in nanoseconds since the first packet. */
+uint64_t pacer_advance(struct pacer *p, size_t size)
+{
+  uint64_t bits, when;
+  double cost;
+
+  bits = wire_bits(size, p->overhead);
+
+  cost = p->ns_per_packet;
+  if (bits * p->ns_per_bit > cost)
+    cost = bits * p->ns_per_bit;
+
+  when = p->next;
+  p->next += cost;
+  p->last = when;
+  p->packets++;
+  p->bits += bits;
+
+  return when;
+}
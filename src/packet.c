@@ -0,0 +1,567 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* AF_PACKET output: Ethernet frames written straight into a PACKET_TX_RING
+   shared with the kernel. Frames skip routing and netfilter, and the ring
+   is kicked once per batch (--batch).
+
+   With --csum-offload each frame starts with a virtio_net_hdr
+   (PACKET_VNET_HDR) asking the kernel, or the NIC, to fill one checksum. */
+
+#include <common.h>
+#include <poll.h>
+#include <linux/if.h>
+#include <net/if_arp.h>
+#include <net/route.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/if_packet.h>
+#include <linux/virtio_net.h>
+
+/* Ring memory per worker (bytes). Grown if --batch needs more frames. */
+#define PACKET_RING_SIZE    (4 * 1024 * 1024)
+
+/* Minimum ring block size (bytes). Must be a power of two pages. */
+#define PACKET_BLOCK_SIZE   (64 * 1024)
+
+/* Where the frame data starts on a TPACKET_V2 tx frame. */
+#define TX_DATA_OFFSET      (TPACKET2_HDRLEN - sizeof(struct sockaddr_ll))
+
+/* Maximum number of tries to kick the ring or wait for a frame. */
+#define MAX_KICK_TRIES      100
+
+/* How long to wait for ARP to resolve the next hop (tenths of second). */
+#define ARP_WAIT            30
+
+/* NOTE: All the state below is private to each worker thread. */
+static __thread socket_t fd = -1;
+static __thread void *ring = NULL;
+static __thread size_t ring_size;
+static __thread unsigned frame_size;
+static __thread unsigned frame_nr;
+static __thread unsigned head;              /* next frame to fill             */
+static __thread unsigned pending;           /* frames filled, not counted yet */
+static __thread unsigned batch;
+static __thread struct sockaddr_ll peer;    /* interface and protocol         */
+static __thread struct ethhdr eth;          /* prebuilt Ethernet header       */
+static __thread unsigned vnet;              /* virtio_net_hdr size, if any    */
+
+static int resolveNextHop(const struct config_options * const __restrict__, const struct cidr *, uint8_t *);
+static int routeNextHop(const char *, in_addr_t, in_addr_t *, in_addr_t *);
+static int arpLookup(const char *, in_addr_t, uint8_t *);
+static int kick(int);
+static void reap(void);
+static void offloadChecksum(struct virtio_net_hdr *, const void *, size_t);
+
+/* Gets interface MAC and checks it can carry the frames. Runs on the main thread. */
+int packetSetup(struct config_options * const __restrict__ co, const struct cidr *c)
+{
+  int ifindex, type, mtu;
+
+  if (!getInterfaceInfo(co->interface, &ifindex, &type, &mtu, co->src_mac))
+    return FALSE;
+
+  switch (type)
+  {
+    case ARPHRD_LOOPBACK:
+      /* NOTE: Loopback takes Ethernet framing, but has no addresses. */
+      if (!co->dst_mac_set)
+        memset(co->dst_mac, 0, ETH_ALEN);
+      break;
+
+    case ARPHRD_ETHER:
+      if (!co->dst_mac_set)
+        if (!resolveNextHop(co, c, co->dst_mac))
+          return FALSE;
+      break;
+
+    default:
+      fprintf(stderr, "%s: interface %s is not an Ethernet interface\n", PACKAGE, co->interface);
+      return FALSE;
+  }
+
+  printf("Sending on %s to %02x:%02x:%02x:%02x:%02x:%02x%s\n",
+         co->interface,
+         co->dst_mac[0], co->dst_mac[1], co->dst_mac[2],
+         co->dst_mac[3], co->dst_mac[4], co->dst_mac[5],
+         co->qdisc_bypass ? " (qdisc bypass)" : "");
+
+  return TRUE;
+}
+
+/* Creates the worker socket and maps its tx ring. */
+int packetOpen(const struct config_options * const __restrict__ co, unsigned id)
+{
+  struct tpacket_req req = {};
+  struct sockaddr_ll sll = {};
+  int ifindex, type, mtu, n;
+  unsigned frames, block_size;
+
+  UNUSED_PARAM(id);
+
+  if (!getInterfaceInfo(co->interface, &ifindex, &type, &mtu, eth.h_source))
+    return FALSE;
+
+  if ((fd = socket(AF_PACKET, SOCK_RAW, 0)) == -1)
+  {
+    perror("error opening packet socket");
+    return FALSE;
+  }
+
+  n = TPACKET_V2;
+  if (setsockopt(fd, SOL_PACKET, PACKET_VERSION, &n, sizeof(n)) == -1)
+  {
+    perror("error setting packet socket version");
+    return FALSE;
+  }
+
+  /* Malformed frames are skipped instead of stopping the ring. */
+  n = 1;
+  if (setsockopt(fd, SOL_PACKET, PACKET_LOSS, &n, sizeof(n)) == -1)
+  {
+    perror("error setting packet socket options");
+    return FALSE;
+  }
+
+  if (co->qdisc_bypass)
+  {
+    n = 1;
+    if (setsockopt(fd, SOL_PACKET, PACKET_QDISC_BYPASS, &n, sizeof(n)) == -1)
+    {
+      perror("error setting qdisc bypass");
+      return FALSE;
+    }
+  }
+
+  /* NOTE: Must come before the ring. */
+  vnet = 0;
+  if (co->csum_offload)
+  {
+    n = 1;
+    if (setsockopt(fd, SOL_PACKET, PACKET_VNET_HDR, &n, sizeof(n)) == -1)
+    {
+      perror("error setting packet socket vnet header");
+      return FALSE;
+    }
+    vnet = sizeof(struct virtio_net_hdr);
+  }
+
+  /* Frame size is the smallest power of two holding a full MTU frame,
+     so frames never cross ring blocks. */
+  if (mtu > UINT16_MAX)
+    mtu = UINT16_MAX;
+  for (frame_size = TPACKET_ALIGNMENT; frame_size < TX_DATA_OFFSET + vnet + ETH_HLEN + mtu; frame_size <<= 1);
+
+  batch = co->batch;
+  frames = PACKET_RING_SIZE / frame_size;
+  if (frames < 2 * batch)
+    frames = 2 * batch;
+
+  block_size = frame_size > PACKET_BLOCK_SIZE ? frame_size : PACKET_BLOCK_SIZE;
+  req.tp_block_size = block_size;
+  req.tp_frame_size = frame_size;
+  req.tp_block_nr   = (frames * frame_size + block_size - 1) / block_size;
+  req.tp_frame_nr   = req.tp_block_nr * (block_size / frame_size);
+
+  if (setsockopt(fd, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req)) == -1)
+  {
+    perror("error setting packet tx ring");
+    return FALSE;
+  }
+
+  frame_nr = req.tp_frame_nr;
+  ring_size = (size_t)req.tp_block_nr * block_size;
+
+  if ((ring = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+  {
+    ring = NULL;
+    perror("error mapping packet tx ring");
+    return FALSE;
+  }
+
+  /* NOTE: Protocol 0 on bind: the socket doesn't receive anything. */
+  sll.sll_family  = AF_PACKET;
+  sll.sll_ifindex = ifindex;
+  if (bind(fd, (struct sockaddr *)&sll, sizeof(sll)) == -1)
+  {
+    perror("error binding packet socket");
+    return FALSE;
+  }
+
+  /* Used on every kick: frames are IPv4 to this interface. */
+  peer = sll;
+  peer.sll_protocol = htons(ETH_P_IP);
+  peer.sll_halen = ETH_ALEN;
+  memcpy(peer.sll_addr, co->dst_mac, ETH_ALEN);
+
+  memcpy(eth.h_dest, co->dst_mac, ETH_ALEN);
+  eth.h_proto = htons(ETH_P_IP);
+
+  head = pending = 0;
+
+  return TRUE;
+}
+
+void packetClose(void)
+{
+  if (ring != NULL)
+  {
+    munmap(ring, ring_size);
+    ring = NULL;
+  }
+
+  if (fd != -1)
+  {
+    close(fd);
+    fd = -1;
+  }
+}
+
+/* Copies the packet to the next free frame. The ring is kicked when 'batch'
+   frames are waiting. */
+int packetSend(const void * const buffer, size_t size, const struct config_options * const __restrict__ co)
+{
+  struct tpacket2_hdr *hdr;
+  void *data;
+  int tries;
+
+  UNUSED_PARAM(co);
+
+  assert(buffer != NULL);
+  assert(size > 0);
+
+  if (TX_DATA_OFFSET + vnet + ETH_HLEN + size > frame_size)
+  {
+    STATS_ERROR(EMSGSIZE);
+    ERROR("Packet is bigger than the interface MTU.");
+    return FALSE;
+  }
+
+  hdr = ring + (size_t)head * frame_size;
+
+  /* Ring full: the kernel still owns the frame. Kick and wait for it. */
+  for (tries = MAX_KICK_TRIES; __atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE) != TP_STATUS_AVAILABLE; )
+  {
+    struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+
+    if (pending && !kick(MSG_DONTWAIT))
+      return FALSE;
+
+    if (!tries--)
+    {
+      ERROR("Error waiting for a free ring frame.");
+      return FALSE;
+    }
+
+    poll(&pfd, 1, 100);
+    syscalls_made++;
+  }
+
+  data = (void *)hdr + TX_DATA_OFFSET;
+  if (vnet)
+  {
+    offloadChecksum(data, buffer, size);
+    data += vnet;
+  }
+  memcpy(data, &eth, ETH_HLEN);
+  memcpy(data + ETH_HLEN, buffer, size);
+
+  ip_fill_checksum(data + ETH_HLEN, size);
+
+  hdr->tp_len = vnet + ETH_HLEN + size;
+  __atomic_store_n(&hdr->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+
+  if (++head == frame_nr)
+    head = 0;
+
+  if (++pending >= batch)
+    return kick(MSG_DONTWAIT);
+
+  return TRUE;
+}
+
+/* Sends the frames still waiting and waits for the ring to drain. */
+int packetFlush(void)
+{
+  return kick(0);
+}
+
+/* Asks the kernel to send the filled frames. */
+static int kick(int flags)
+{
+  int tries;
+
+  for (tries = MAX_KICK_TRIES; tries; )
+  {
+    ssize_t n = sendto(fd, NULL, 0, flags, (struct sockaddr *)&peer, sizeof(peer));
+
+    syscalls_made++;
+    reap();
+
+    if (n != -1)
+      return TRUE;
+
+    STATS_ERROR(errno);
+
+    /* NOTE: ENOBUFS means the device queue is full. The frames before the
+             one which failed are gone (and counted above); that one is
+             marked for sending again by the kernel, with the rest. Just
+             try again, as the socket backends do. */
+    if (errno == ENOBUFS)
+      continue;
+
+    if (errno != EAGAIN && errno != EINTR)
+      break;
+
+    tries--;
+  }
+
+  ERROR("Error sending ring frames.");
+  return FALSE;
+}
+
+/* Counts the frames the kernel took: from the oldest pending one up to
+   the first still waiting to be sent. Sizes are read back from the frames. */
+static void reap(void)
+{
+  unsigned n = head >= pending ? head - pending : head + frame_nr - pending;
+
+  for (; pending; pending--)
+  {
+    struct tpacket2_hdr *hdr = ring + (size_t)n * frame_size;
+
+    if (__atomic_load_n(&hdr->tp_status, __ATOMIC_ACQUIRE) & TP_STATUS_SEND_REQUEST)
+      break;
+
+    packets_sent++;
+    STATS_ADD(packets, 1);
+    STATS_ADD(bytes, hdr->tp_len - vnet - ETH_HLEN);
+
+    if (++n == frame_nr)
+      n = 0;
+  }
+}
+
+/* Points the kernel to the checksum the modules left undone (see
+   CSUM_OFFLOAD_L4()): the GRE one, if present, or else the TCP, UDP or
+   DCCP one, encapsulated or not. Other frames get no request. */
+static void offloadChecksum(struct virtio_net_hdr *vh, const void *buffer, size_t size)
+{
+  const struct iphdr *ip = buffer;
+  size_t offset = ip->ihl * 4, field;
+
+  memset(vh, 0, sizeof(struct virtio_net_hdr));
+
+  if (ip->protocol == IPPROTO_GRE && offset + sizeof(struct gre_hdr) <= size)
+  {
+    const struct gre_hdr *gre = buffer + offset;
+
+    if (gre->C)
+    {
+      vh->flags       = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+      vh->csum_start  = ETH_HLEN + offset;
+      vh->csum_offset = sizeof(struct gre_hdr) + offsetof(struct gre_sum_hdr, check);
+      return;
+    }
+
+    offset += sizeof(struct gre_hdr) +
+              (gre->K ? GRE_OPTLEN_KEY : 0) +
+              (gre->S ? GRE_OPTLEN_SEQUENCE : 0);
+    if (offset + sizeof(struct iphdr) > size)
+      return;
+
+    ip = buffer + offset;
+    offset += ip->ihl * 4;
+  }
+
+  switch (ip->protocol)
+  {
+    case IPPROTO_TCP:  field = offsetof(struct tcphdr, check); break;
+    case IPPROTO_UDP:  field = offsetof(struct udphdr, check); break;
+    case IPPROTO_DCCP: field = offsetof(struct dccp_hdr, dccph_checksum); break;
+    default:           return;
+  }
+
+  if (offset + field + sizeof(uint16_t) <= size)
+  {
+    vh->flags       = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+    vh->csum_start  = ETH_HLEN + offset;
+    vh->csum_offset = field;
+  }
+}
+
+/* Gets the interface index, hardware type, MTU and address. */
+int getInterfaceInfo(const char *name, int *ifindex, int *type, int *mtu, uint8_t *mac)
+{
+  struct ifreq ifr = {};
+  socket_t s;
+  int ok = FALSE;
+
+  if ((s = socket(AF_INET, SOCK_DGRAM, 0)) == -1)
+  {
+    perror("error opening socket");
+    return FALSE;
+  }
+
+  strncpy(ifr.ifr_name, name, IFNAMSIZ - 1);
+  if (strlen(name) >= IFNAMSIZ || ioctl(s, SIOCGIFINDEX, &ifr) == -1)
+  {
+    fprintf(stderr, "%s: unknown interface %s\n", PACKAGE, name);
+    goto out;
+  }
+  *ifindex = ifr.ifr_ifindex;
+
+  if (ioctl(s, SIOCGIFHWADDR, &ifr) == -1)
+  {
+    perror("error getting interface address");
+    goto out;
+  }
+  *type = ifr.ifr_hwaddr.sa_family;
+  memcpy(mac, ifr.ifr_hwaddr.sa_data, ETH_ALEN);
+
+  if (ioctl(s, SIOCGIFMTU, &ifr) == -1)
+  {
+    perror("error getting interface MTU");
+    goto out;
+  }
+  *mtu = ifr.ifr_mtu;
+  ok = TRUE;
+
+out:
+  close(s);
+  return ok;
+}
+
+/* Finds the next hop MAC address on the ARP cache, asking the kernel to
+   resolve it if needed. Every target must go through the same next hop:
+   the routes of the lowest and highest hosts are checked. */
+static int resolveNextHop(const struct config_options * const __restrict__ co, const struct cidr *c, uint8_t *mac)
+{
+  struct sockaddr_in sin = { .sin_family = AF_INET, .sin_port = htons(9) };
+  in_addr_t target[2], nexthop[2], mask;
+  socket_t s;
+  int i, n = c->hostid > 1 ? 2 : 1;
+
+  target[0] = htonl(cidr_flow_address(c, DEST_SEQUENTIAL, 0));
+  target[1] = htonl(cidr_flow_address(c, DEST_SEQUENTIAL, c->hostid - 1));
+
+  for (i = 0; i < n; i++)
+    if (!routeNextHop(co->interface, target[i], &nexthop[i], &mask))
+    {
+      fprintf(stderr, "%s: no route to %s on %s (use --dst-mac)\n",
+              PACKAGE, inet_ntoa(*(struct in_addr *)&target[i]), co->interface);
+      return FALSE;
+    }
+
+  /* FIX: On link targets have a MAC address each. Can't send many of them
+          to one next hop. */
+  if (n > 1 && (nexthop[0] == target[0] || nexthop[1] == target[1]))
+  {
+    ERROR("on link targets need --dst-mac");
+    return FALSE;
+  }
+
+  if (n > 1 && nexthop[0] != nexthop[1])
+  {
+    ERROR("targets have different next hops (use --dst-mac)");
+    return FALSE;
+  }
+
+  if (arpLookup(co->interface, nexthop[0], mac))
+    return TRUE;
+
+  /* Any datagram to the next hop makes the kernel resolve it. */
+  if ((s = socket(AF_INET, SOCK_DGRAM, 0)) != -1)
+  {
+    setsockopt(s, SOL_SOCKET, SO_BINDTODEVICE, co->interface, strlen(co->interface) + 1);
+    sin.sin_addr.s_addr = nexthop[0];
+    sendto(s, "", 0, 0, (struct sockaddr *)&sin, sizeof(sin));
+    close(s);
+  }
+
+  for (i = 0; i < ARP_WAIT; i++)
+  {
+    usleep(100000);
+    if (arpLookup(co->interface, nexthop[0], mac))
+      return TRUE;
+  }
+
+  fprintf(stderr, "%s: can't resolve the MAC address of %s on %s (use --dst-mac)\n",
+          PACKAGE, inet_ntoa(sin.sin_addr), co->interface);
+  return FALSE;
+}
+
+/* Longest prefix match on /proc/net/route, for the interface only.
+   NOTE: Addresses there are the hex dump of the network order values. */
+static int routeNextHop(const char *ifname, in_addr_t daddr, in_addr_t *nexthop, in_addr_t *mask)
+{
+  FILE *f;
+  char line[256], iface[IFNAMSIZ + 1];
+  unsigned dest, gw, flags, msk;
+  int found = FALSE;
+
+  if ((f = fopen("/proc/net/route", "r")) == NULL)
+    return FALSE;
+
+  while (fgets(line, sizeof(line), f) != NULL)
+  {
+    if (sscanf(line, "%16s %x %x %x %*d %*d %*d %x", iface, &dest, &gw, &flags, &msk) != 5)
+      continue;
+
+    if (strcmp(iface, ifname) != 0 || !(flags & RTF_UP) || (daddr & msk) != dest)
+      continue;
+
+    if (!found || ntohl(msk) > ntohl(*mask))
+    {
+      *nexthop = (flags & RTF_GATEWAY) ? gw : daddr;
+      *mask = msk;
+      found = TRUE;
+    }
+  }
+
+  fclose(f);
+  return found;
+}
+
+/* Looks for a complete entry on /proc/net/arp. */
+static int arpLookup(const char *ifname, in_addr_t addr, uint8_t *mac)
+{
+  FILE *f;
+  char line[256], ip[16], hw[18], iface[IFNAMSIZ + 1];
+  unsigned flags;
+  int found = FALSE;
+
+  if ((f = fopen("/proc/net/arp", "r")) == NULL)
+    return FALSE;
+
+  while (!found && fgets(line, sizeof(line), f) != NULL)
+  {
+    if (sscanf(line, "%15s %*x %x %17s %*s %16s", ip, &flags, hw, iface) != 4)
+      continue;
+
+    if (!(flags & ATF_COM) || strcmp(iface, ifname) != 0 || inet_addr(ip) != addr)
+      continue;
+
+    found = sscanf(hw, "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
+                   &mac[0], &mac[1], &mac[2], &mac[3], &mac[4], &mac[5]) == 6;
+  }
+
+  fclose(f);
+  return found;
+}
@@ -0,0 +1,338 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* pcap and pcapng file output. Packets are appended to a large per worker
+   buffer, written with a single write() when full. All the workers share
+   one file (whole buffers are written under a lock, so records are never
+   split) unless --file-per-worker is given.
+
+   Timestamps follow --pps/--bps, as if the packets were sent at that rate
+   from the start of the run, but nothing waits for them. Without a rate,
+   the real time of each packet is used. */
+
+#include <common.h>
+
+/* Write buffer per worker (bytes). */
+#define PCAP_BUFFER_SIZE    (4 * 1024 * 1024)
+
+/* Largest record captured. */
+#define PCAP_SNAPLEN        65535
+
+/* Link type: packets start at the IPv4 header. */
+#define LINKTYPE_RAW        101
+
+/* pcap: nanosecond resolution magic. */
+#define PCAP_MAGIC_NS       0xa1b23c4d
+
+/* pcapng block types. */
+#define PCAPNG_SHB          0x0a0d0d0a
+#define PCAPNG_IDB          0x00000001
+#define PCAPNG_EPB          0x00000006
+#define PCAPNG_BOM          0x1a2b3c4d
+
+struct pcap_file_header {
+  uint32_t magic;
+  uint16_t version_major;
+  uint16_t version_minor;
+  int32_t  thiszone;
+  uint32_t sigfigs;
+  uint32_t snaplen;
+  uint32_t linktype;
+};
+
+struct pcap_record {
+  uint32_t ts_sec;
+  uint32_t ts_nsec;
+  uint32_t caplen;
+  uint32_t len;
+};
+
+/* Section header and interface description (with if_tsresol = 9) blocks. */
+struct pcapng_header {
+  uint32_t shb_type, shb_len, bom;
+  uint16_t version_major, version_minor;
+  int64_t  section_len;
+  uint32_t shb_len2;
+  uint32_t idb_type, idb_len;
+  uint16_t linktype, reserved;
+  uint32_t snaplen;
+  uint16_t opt_tsresol, opt_tsresol_len;
+  uint8_t  tsresol, pad[3];
+  uint16_t opt_end, opt_end_len;
+  uint32_t idb_len2;
+} __attribute__((packed));
+
+struct pcapng_epb {
+  uint32_t type, len;
+  uint32_t interface;
+  uint32_t ts_high, ts_low;
+  uint32_t caplen, origlen;
+};
+
+/* Shared file (no --file-per-worker). Opened by pcapSetup(), on the main
+   thread, and closed at exit. */
+static int shared_fd = -1;
+static pthread_mutex_t shared_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Run start (realtime), the base of the synthetic timestamps. */
+static uint64_t start_ns;
+
+/* NOTE: All the state below is private to each worker thread. */
+static __thread int fd = -1;
+static __thread int pcapng;
+static __thread void *buffer = NULL;
+static __thread size_t used;
+static __thread struct pacer stamp;         /* synthetic timestamps           */
+static __thread int synthetic;
+
+static int  openFile(const char *, int);
+static int  writeBuffer(void);
+
+int pcapSetup(struct config_options * const __restrict__ co, const struct cidr *c)
+{
+  struct timespec ts;
+
+  UNUSED_PARAM(c);
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+  start_ns = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+
+  if (co->file_per_worker)
+    return TRUE;
+
+  /* NOTE: Each worker stamps its packets at its share of the rate and
+           writes them in blocks: time would go back and forth on a
+           shared file, which replay tools don't take. */
+  if (co->workers > 1 && (co->pps > 0 || co->bps > 0))
+  {
+    ERROR("--pps and --bps with several workers need --file-per-worker");
+    return FALSE;
+  }
+
+  return (shared_fd = openFile(co->write_file, co->output == OUTPUT_PCAPNG)) != -1;
+}
+
+/* Gets the worker buffer and, with --file-per-worker, its own file
+   (ex: "out.pcap" becomes "out.0.pcap", "out.1.pcap", ...). */
+int pcapOpen(const struct config_options * const __restrict__ co, unsigned id)
+{
+  pcapng = co->output == OUTPUT_PCAPNG;
+
+  if ((buffer = malloc(PCAP_BUFFER_SIZE)) == NULL)
+  {
+    ERROR("Error allocating file buffer");
+    return FALSE;
+  }
+  used = 0;
+
+  synthetic = co->pps > 0 || co->bps > 0;
+  if (synthetic)
+    pacer_init(&stamp, co, co->workers);
+
+  if (co->file_per_worker)
+  {
+    const char *name = co->write_file, *dot = strrchr(name, '.');
+    char *path;
+    int n;
+
+    if (dot == NULL || strchr(dot, '/') != NULL || dot == name)
+      dot = name + strlen(name);
+
+    if (asprintf(&path, "%.*s.%u%s", (int)(dot - name), name, id, dot) == -1)
+    {
+      ERROR("Error allocating file name");
+      return FALSE;
+    }
+
+    n = openFile(path, pcapng);
+    free(path);
+    if ((fd = n) == -1)
+      return FALSE;
+  }
+  else
+    fd = shared_fd;
+
+  return TRUE;
+}
+
+void pcapClose(void)
+{
+  if (fd != -1 && fd != shared_fd)
+    close(fd);
+  fd = -1;
+
+  free(buffer);
+  buffer = NULL;
+}
+
+/* Appends one record to the worker buffer. */
+int pcapSend(const void * const packet, size_t size, const struct config_options * const __restrict__ co)
+{
+  size_t caplen = size > PCAP_SNAPLEN ? PCAP_SNAPLEN : size;
+  size_t pad = pcapng ? -caplen & 3 : 0;
+  size_t len;
+  uint64_t ns;
+
+  UNUSED_PARAM(co);
+
+  assert(packet != NULL);
+  assert(size > 0);
+
+  len = caplen + pad + (pcapng ? sizeof(struct pcapng_epb) + sizeof(uint32_t)
+                               : sizeof(struct pcap_record));
+
+  if (used + len > PCAP_BUFFER_SIZE)
+    if (!writeBuffer())
+      return FALSE;
+
+  if (synthetic)
+    ns = start_ns + pacer_advance(&stamp, size);
+  else
+  {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ns = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+  }
+
+  if (pcapng)
+  {
+    struct pcapng_epb *epb = buffer + used;
+
+    epb->type = PCAPNG_EPB;
+    epb->len = len;
+    epb->interface = 0;
+    epb->ts_high = ns >> 32;
+    epb->ts_low = ns;
+    epb->caplen = caplen;
+    epb->origlen = size;
+    memcpy(epb + 1, packet, caplen);
+    ip_fill_checksum(epb + 1, caplen);
+    memset((void *)(epb + 1) + caplen, 0, pad);
+    *(uint32_t *)((void *)(epb + 1) + caplen + pad) = len;
+  }
+  else
+  {
+    struct pcap_record *rec = buffer + used;
+
+    rec->ts_sec = ns / 1000000000ULL;
+    rec->ts_nsec = ns % 1000000000ULL;
+    rec->caplen = caplen;
+    rec->len = size;
+    memcpy(rec + 1, packet, caplen);
+    ip_fill_checksum(rec + 1, caplen);
+  }
+
+  used += len;
+
+  packets_sent++;
+  STATS_ADD(packets, 1);
+  STATS_ADD(bytes, size);
+
+  return TRUE;
+}
+
+int pcapFlush(void)
+{
+  return writeBuffer();
+}
+
+/* Writes the whole buffer to the file. */
+static int writeBuffer(void)
+{
+  size_t done = 0;
+  int ok = TRUE;
+
+  if (used == 0)
+    return TRUE;
+
+  if (fd == shared_fd)
+    pthread_mutex_lock(&shared_mutex);
+
+  while (done < used)
+  {
+    ssize_t n = write(fd, buffer + done, used - done);
+
+    syscalls_made++;
+    if (n == -1)
+    {
+      if (errno == EINTR)
+        continue;
+
+      STATS_ERROR(errno);
+      perror("error writing capture file");
+      ok = FALSE;
+      break;
+    }
+
+    done += n;
+  }
+
+  if (fd == shared_fd)
+    pthread_mutex_unlock(&shared_mutex);
+
+  used = 0;
+  return ok;
+}
+
+/* Creates the file and writes its header. Returns -1 on error. */
+static int openFile(const char *name, int ng)
+{
+  struct pcap_file_header ph = {
+    .magic = PCAP_MAGIC_NS,
+    .version_major = 2,
+    .version_minor = 4,
+    .snaplen = PCAP_SNAPLEN,
+    .linktype = LINKTYPE_RAW
+  };
+  struct pcapng_header nh = {
+    .shb_type = PCAPNG_SHB,
+    .shb_len = 28,
+    .bom = PCAPNG_BOM,
+    .version_major = 1,
+    .section_len = -1,
+    .shb_len2 = 28,
+    .idb_type = PCAPNG_IDB,
+    .idb_len = 32,
+    .linktype = LINKTYPE_RAW,
+    .snaplen = PCAP_SNAPLEN,
+    .opt_tsresol = 9,                 /* if_tsresol: 10^-9 s */
+    .opt_tsresol_len = 1,
+    .tsresol = 9,
+    .idb_len2 = 32
+  };
+  const void *header = ng ? (const void *)&nh : (const void *)&ph;
+  size_t size = ng ? sizeof(nh) : sizeof(ph);
+  int f;
+
+  if ((f = open(name, O_WRONLY | O_CREAT | O_TRUNC, 0644)) == -1)
+  {
+    fprintf(stderr, "%s: error creating %s: %s\n", PACKAGE, name, strerror(errno));
+    return -1;
+  }
+
+  if (write(f, header, size) != (ssize_t)size)
+  {
+    fprintf(stderr, "%s: error writing %s: %s\n", PACKAGE, name, strerror(errno));
+    close(f);
+    return -1;
+  }
+
+  return f;
+}
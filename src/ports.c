@@ -0,0 +1,92 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <common.h>
+
+/* Parses "80,443,8000-8100" lists. Port 0 is not allowed: on a single
+   port it means random. Returns FALSE if invalid. */
+int parsePortList(const char *str, uint16_t **list, unsigned *count)
+{
+  uint16_t *p = NULL;
+  unsigned n = 0;
+  const char *s = str;
+  char *end;
+  long first, last;
+
+  assert(str != NULL);
+
+  while (*s)
+  {
+    void *q;
+
+    first = strtol(s, &end, 10);
+    if (end == s || first < 1 || first > 65535)
+      goto error;
+
+    last = first;
+    if (*end == '-')
+    {
+      s = end + 1;
+      last = strtol(s, &end, 10);
+      if (end == s || last < first || last > 65535)
+        goto error;
+    }
+
+    if (*end != ',' && *end != '\0')
+      goto error;
+
+    if ((q = realloc(p, (n + last - first + 1) * sizeof(uint16_t))) == NULL)
+    {
+      ERROR("Error allocating port list");
+      exit(EXIT_FAILURE);
+    }
+
+    for (p = q; first <= last; first++)
+      p[n++] = first;
+
+    s = (*end == ',') ? end + 1 : end;
+  }
+
+  if (n == 0)
+    goto error;
+
+  *list = p;
+  *count = n;
+  return TRUE;
+
+error:
+  free(p);
+  return FALSE;
+}
+
+/* Fisher-Yates shuffle (--port-mode PERMUTE). Called on the main thread,
+   after the seed. */
+void shufflePorts(uint16_t *list, unsigned n)
+{
+  unsigned i;
+
+  for (i = n - 1; i > 0; i--)
+  {
+    unsigned j = random_range(i + 1);
+    uint16_t t = list[i];
+
+    list[i] = list[j];
+    list[j] = t;
+  }
+}
@@ -0,0 +1,244 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <common.h>
+
+/* NOTE: Any non zero state works. This one is used by threads which don't
+         call random_attach(). */
+__thread uint64_t random_state[4] = {
+  0x9e3779b97f4a7c15ULL, 0xbf58476d1ce4e5b9ULL,
+  0x94d049bb133111ebULL, 0x2545f4914f6cdd1dULL
+};
+
+static uint64_t base_seed;
+
+/* Bulk fills run RANDOM_LANES xoshiro256++ generators side by side, one per
+   vector lane: 32 bytes each step, in one AVX2 register or two SSE2 ones.
+   The GCC vector type is lowered to what the function target allows, so
+   the same code is built for each and random_init() picks one at startup
+   (cpuid), as cksum_init() does. The lanes are seeded from the scalar
+   generator the first time they're needed after random_attach() or
+   random_packet(), so --seed still holds (on any of them). */
+#define RANDOM_LANES 4
+
+typedef uint64_t lanes_t __attribute__((vector_size(RANDOM_LANES * sizeof(uint64_t))));
+
+static __thread lanes_t lanes[4];
+static __thread int lanes_ready;
+
+#ifndef __HAVE_RDRAND__
+static size_t random_fill_lanes_generic(uint8_t *, size_t);
+
+static size_t (*random_fill_lanes)(uint8_t *, size_t) = random_fill_lanes_generic;
+#endif
+
+/* Below this size the scalar generator is cheaper. */
+#define RANDOM_BULK_MIN sizeof(lanes_t)
+
+/* Philox4x32-10 constants (Salmon et al., "Parallel random numbers: as easy
+   as 1, 2, 3", SC'11). */
+#define PHILOX_M0 0xd2511f53U
+#define PHILOX_M1 0xcd9e8d57U
+#define PHILOX_W0 0x9e3779b9U
+#define PHILOX_W1 0xbb67ae85U
+
+/* Counter based generator: the output depends only on the key and the
+   counter, so any block of the stream is computed directly. */
+static void philox4x32(uint32_t ctr[4], uint32_t k0, uint32_t k1)
+{
+  int i;
+
+  for (i = 0; i < 10; i++)
+  {
+    uint64_t p0 = (uint64_t)PHILOX_M0 * ctr[0];
+    uint64_t p1 = (uint64_t)PHILOX_M1 * ctr[2];
+
+    ctr[0] = (uint32_t)(p1 >> 32) ^ ctr[1] ^ k0;
+    ctr[1] = (uint32_t)p1;
+    ctr[2] = (uint32_t)(p0 >> 32) ^ ctr[3] ^ k1;
+    ctr[3] = (uint32_t)p0;
+
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+}
+
+/* SplitMix64: spreads a seed over the xoshiro state. */
+static uint64_t splitmix64(uint64_t *x)
+{
+  uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+void random_seed(uint64_t seed)
+{
+  base_seed = seed;
+  random_attach(0);
+}
+
+/* Each worker gets its own stream, from the base seed and its number. */
+void random_attach(unsigned id)
+{
+  uint64_t x = base_seed ^ ((uint64_t)id << 32);
+  int i;
+
+  for (i = 0; i < 4; i++)
+    random_state[i] = splitmix64(&x);
+
+  lanes_ready = 0;
+}
+
+#ifndef __HAVE_RDRAND__
+/* Fills whole lanes_t blocks. Returns the number of bytes written.
+   NOTE: Always inlined, so it's built for each caller's target. */
+static inline __attribute__((always_inline)) size_t fill_lanes(uint8_t *p, size_t n)
+{
+  lanes_t s0, s1, s2, s3, r, t;
+  size_t done;
+
+  if (!lanes_ready)
+  {
+    uint64_t x = random_next();
+    uint64_t *w = (uint64_t *)lanes;
+    size_t i;
+
+    for (i = 0; i < 4 * RANDOM_LANES; i++)
+      w[i] = splitmix64(&x);
+    lanes_ready = 1;
+  }
+
+  s0 = lanes[0]; s1 = lanes[1]; s2 = lanes[2]; s3 = lanes[3];
+
+  for (done = 0; n - done >= sizeof(lanes_t); done += sizeof(lanes_t))
+  {
+    /* xoshiro256++, as random_next(), on every lane. */
+    r = s0 + s3;
+    r = ((r << 23) | (r >> 41)) + s0;
+    memcpy(p + done, &r, sizeof(r));
+
+    t = s1 << 17;
+    s2 ^= s0;
+    s3 ^= s1;
+    s1 ^= s2;
+    s0 ^= s3;
+    s2 ^= t;
+    s3 = (s3 << 45) | (s3 >> 19);
+  }
+
+  lanes[0] = s0; lanes[1] = s1; lanes[2] = s2; lanes[3] = s3;
+
+  return done;
+}
+
+/* Built with the compiler flags (no SIMD assumed beyond them). */
+static size_t random_fill_lanes_generic(uint8_t *p, size_t n)
+{
+  return fill_lanes(p, n);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2")))
+static size_t random_fill_lanes_sse2(uint8_t *p, size_t n)
+{
+  return fill_lanes(p, n);
+}
+
+__attribute__((target("avx2")))
+static size_t random_fill_lanes_avx2(uint8_t *p, size_t n)
+{
+  return fill_lanes(p, n);
+}
+#endif
+#endif
+
+/* Selects the bulk fill implementation, once, before the workers start. */
+void random_init(void)
+{
+#if !defined(__HAVE_RDRAND__) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2"))
+    random_fill_lanes = random_fill_lanes_avx2;
+  else if (__builtin_cpu_supports("sse2"))
+    random_fill_lanes = random_fill_lanes_sse2;
+#endif
+}
+
+void random_fill(void *buffer, size_t n)
+{
+  uint8_t *p = buffer;
+  uint64_t r;
+
+#ifndef __HAVE_RDRAND__
+  if (n >= RANDOM_BULK_MIN)
+  {
+    size_t done = random_fill_lanes(p, n);
+
+    p += done;
+    n -= done;
+  }
+#endif
+
+  for (; n >= 8; n -= 8, p += 8)
+  {
+#ifdef __HAVE_RDRAND__
+    r = ((uint64_t)readrand() << 32) | readrand();
+#else
+    r = random_next();
+#endif
+    memcpy(p, &r, 8);
+  }
+
+  if (n)
+  {
+#ifdef __HAVE_RDRAND__
+    r = ((uint64_t)readrand() << 32) | readrand();
+#else
+    r = random_next();
+#endif
+    memcpy(p, &r, n);
+  }
+}
+
+void random_bulk(uint32_t *words, size_t n)
+{
+  random_fill(words, n * sizeof(uint32_t));
+}
+
+/* Restarts the worker generator on the stream of packet 'i': Philox of the
+   base seed and (i, block) gives the xoshiro state. Every draw made for the
+   packet then depends only on the seed and i, whoever builds it. */
+void random_packet(uint64_t i)
+{
+  uint32_t a[4] = { (uint32_t)i, (uint32_t)(i >> 32), 0, 0 };
+  uint32_t b[4] = { (uint32_t)i, (uint32_t)(i >> 32), 1, 0 };
+
+  philox4x32(a, (uint32_t)base_seed, (uint32_t)(base_seed >> 32));
+  philox4x32(b, (uint32_t)base_seed, (uint32_t)(base_seed >> 32));
+
+  random_state[0] = ((uint64_t)a[1] << 32) | a[0];
+  random_state[1] = ((uint64_t)a[3] << 32) | a[2];
+  random_state[2] = ((uint64_t)b[1] << 32) | b[0];
+  random_state[3] = ((uint64_t)b[3] << 32) | b[2] | 1;  /* never all zero */
+
+  lanes_ready = 0;
+}
@@ -0,0 +1,281 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <common.h>
+#include <sys/utsname.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+#endif
+
+static void json_string(FILE *, const char *);
+static void json_rate(FILE *, const char *, double);
+static double tv_seconds(const struct timeval *);
+
+/* Reads the time stamp counter (0 if not available).
+   NOTE: Modern x86 TSCs tick at a constant (nominal) rate, so "cycles" below
+         are reference cycles, not core cycles. */
+uint64_t read_tsc(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+/* Writes the end-of-run report, in JSON, to 'filename' ("-" is stdout).
+   Returns FALSE on error. */
+int writeReport(const char *filename,
+                const struct config_options *co,
+                const struct worker *workers,
+                unsigned num_workers,
+                const struct run_times *times)
+{
+  FILE *f;
+  struct stats total;
+  struct rusage ru;
+  struct utsname un;
+  struct in_addr addr;
+  double wall, cpu, tsc_hz;
+  const char *overheads[] = { "NONE", "L2", "L1" };
+  const char *flow_modes[] = { "SEQUENTIAL", "RANDOM", "ZIPF" };
+  const char *dest_modes[] = { "RANDOM", "SEQUENTIAL", "PERMUTE" };
+  unsigned i, first;
+  int status = EXIT_SUCCESS;
+
+  if (strcmp(filename, "-") == 0)
+    f = stdout;
+  else if ((f = fopen(filename, "w")) == NULL)
+  {
+    fprintf(stderr, "%s: error opening report file '%s': %s\n", PACKAGE, filename, strerror(errno));
+    return FALSE;
+  }
+
+  stats_sum(&total);
+  getrusage(RUSAGE_SELF, &ru);
+  uname(&un);
+
+  for (i = 0; i < num_workers; i++)
+    if (workers[i].status != EXIT_SUCCESS)
+      status = EXIT_FAILURE;
+
+  wall = times->wall_ns / 1e9;
+  cpu  = tv_seconds(&ru.ru_utime) + tv_seconds(&ru.ru_stime);
+
+  /* TSC frequency, measured over the whole run. */
+  tsc_hz = (times->wall_ns && times->tsc_cycles) ? times->tsc_cycles / wall : 0;
+
+  fprintf(f, "{\n");
+  fprintf(f, "  \"program\": \"%s\",\n", PACKAGE);
+  fprintf(f, "  \"version\": \"%s\",\n", VERSION);
+  fprintf(f, "  \"host\": ");
+  json_string(f, un.nodename);
+  fprintf(f, ",\n  \"kernel\": ");
+  json_string(f, un.release);
+  fprintf(f, ",\n  \"status\": \"%s\",\n", status == EXIT_SUCCESS ? "success" : "failure");
+
+  /* --- Configuration summary --- */
+  addr.s_addr = co->ip.daddr;
+  fprintf(f, "  \"config\": {\n");
+  fprintf(f, "    \"protocol\": ");
+  json_string(f, co->ip.protocol == IPPROTO_T50 ? "T50" : mod_table[co->ip.protoname].acronym);
+  if (co->mix != NULL)
+  {
+    fprintf(f, ",\n    \"mix\": ");
+    json_string(f, co->mix);
+    fprintf(f, ",\n    \"mix_schedule\": %s", co->mix_schedule ? "true" : "false");
+  }
+  if (co->targets_file != NULL)
+  {
+    fprintf(f, ",\n    \"targets_file\": ");
+    json_string(f, co->targets_file);
+    fprintf(f, ",\n");
+  }
+  else if (co->range_end != INADDR_ANY)
+  {
+    char first[INET_ADDRSTRLEN], last[INET_ADDRSTRLEN];
+
+    inet_ntop(AF_INET, &co->ip.daddr, first, sizeof(first));
+    inet_ntop(AF_INET, &co->range_end, last, sizeof(last));
+    fprintf(f, ",\n    \"destination\": \"%s-%s\",\n", first, last);
+  }
+  else
+    fprintf(f, ",\n    \"destination\": \"%s/%u\",\n", inet_ntoa(addr), co->bits);
+  fprintf(f, "    \"output\": \"%s\",\n", output_table[co->output].name);
+  if (co->seed_set)
+    fprintf(f, "    \"seed\": %" PRIu64 ",\n", co->seed);
+  else
+    fprintf(f, "    \"seed\": null,\n");
+  fprintf(f, "    \"dest_mode\": \"%s\",\n", dest_modes[co->dest_mode]);
+  fprintf(f, "    \"port_mode\": \"%s\",\n", dest_modes[co->port_mode]);
+  fprintf(f, "    \"flows\": %u,\n", co->flows);
+  if (co->flows)
+  {
+    fprintf(f, "    \"flow_mode\": \"%s\",\n", flow_modes[co->flow_mode]);
+    json_rate(f, "    \"flow_churn\": ", co->flow_churn);
+    fprintf(f, ",\n");
+  }
+  fprintf(f, "    \"threshold\": %" PRIu64 ",\n", (uint64_t)co->threshold);
+  fprintf(f, "    \"flood\": %s,\n", co->flood ? "true" : "false");
+  fprintf(f, "    \"workers\": %u,\n", num_workers);
+  fprintf(f, "    \"batch\": %u,\n", co->batch);
+  json_rate(f, "    \"pps\": ", co->pps);
+  json_rate(f, ",\n    \"bps\": ", co->bps);
+  fprintf(f, ",\n    \"overhead\": \"%s\",\n", overheads[co->overhead]);
+  fprintf(f, "    \"encapsulated\": %s,\n", co->encapsulated ? "true" : "false");
+  fprintf(f, "    \"bogus_csum\": %s\n", co->bogus_csum ? "true" : "false");
+  fprintf(f, "  },\n");
+
+  /* --- Times --- */
+  fprintf(f, "  \"time\": {\n");
+  fprintf(f, "    \"wall_s\": %.6f,\n", wall);
+  fprintf(f, "    \"user_s\": %.6f,\n", tv_seconds(&ru.ru_utime));
+  fprintf(f, "    \"system_s\": %.6f,\n", tv_seconds(&ru.ru_stime));
+  fprintf(f, "    \"cpu_s\": %.6f,\n", cpu);
+  json_rate(f, "    \"tsc_hz\": ", tsc_hz);
+  fprintf(f, "\n  },\n");
+
+  fprintf(f, "  \"rusage\": {\n");
+  fprintf(f, "    \"maxrss_kb\": %ld,\n", ru.ru_maxrss);
+  fprintf(f, "    \"minor_faults\": %ld,\n", ru.ru_minflt);
+  fprintf(f, "    \"major_faults\": %ld,\n", ru.ru_majflt);
+  fprintf(f, "    \"voluntary_switches\": %ld,\n", ru.ru_nvcsw);
+  fprintf(f, "    \"involuntary_switches\": %ld\n", ru.ru_nivcsw);
+  fprintf(f, "  },\n");
+
+  /* --- Totals --- */
+  fprintf(f, "  \"packets\": %" PRIu64 ",\n", total.packets);
+  fprintf(f, "  \"bytes\": %" PRIu64 ",\n", total.bytes);
+  fprintf(f, "  \"send_errors\": %" PRIu64 ",\n", total.errors);
+
+  /* NOTE: Module counters are taken when the packet is handed to the socket
+           layer (before batch flushing), so they may exceed 'packets' if a
+           batch failed. */
+  fprintf(f, "  \"modules\": [");
+  for (i = 0, first = TRUE; i < MAXIMUM_MODULES && mod_table[i].func != NULL; i++)
+  {
+    if (total.proto[i] == 0)
+      continue;
+
+    fprintf(f, "%s\n    { \"name\": ", first ? "" : ",");
+    json_string(f, mod_table[i].acronym);
+    fprintf(f, ", \"packets\": %" PRIu64 ", \"bytes\": %" PRIu64,
+      total.proto[i],
+      total.proto_bytes[i]);
+
+    /* Build cost, measured on --output null only. */
+    if (total.proto_cycles[i])
+      json_rate(f, ", \"build_cycles_per_packet\": ", (double)total.proto_cycles[i] / total.proto[i]);
+    fprintf(f, " }");
+    first = FALSE;
+  }
+  fprintf(f, "%s],\n", first ? "" : "\n  ");
+
+  fprintf(f, "  \"errors\": [");
+  for (i = 0, first = TRUE; i < MAXIMUM_ERRNO; i++)
+  {
+    if (total.errnos[i] == 0)
+      continue;
+
+    fprintf(f, "%s\n    { \"errno\": %u, \"message\": ", first ? "" : ",", i);
+    json_string(f, i ? strerror(i) : "other");
+    fprintf(f, ", \"count\": %" PRIu64 " }", total.errnos[i]);
+    first = FALSE;
+  }
+  fprintf(f, "%s],\n", first ? "" : "\n  ");
+
+  /* --- Rates --- */
+  fprintf(f, "  \"rate\": {\n");
+  json_rate(f, "    \"requested_pps\": ", co->pps);
+  json_rate(f, ",\n    \"requested_bps\": ", co->bps);
+  json_rate(f, ",\n    \"achieved_pps\": ", wall > 0 ? total.packets / wall : 0);
+  json_rate(f, ",\n    \"achieved_bps\": ", wall > 0 ? total.bytes * 8 / wall : 0);
+  fprintf(f, "\n  },\n");
+
+  /* --- Efficiency --- */
+  fprintf(f, "  \"efficiency\": {\n");
+  json_rate(f, "    \"cpu_ns_per_packet\": ", total.packets ? cpu * 1e9 / total.packets : 0);
+  json_rate(f, ",\n    \"cycles_per_packet\": ", total.packets ? cpu * tsc_hz / total.packets : 0);
+  fprintf(f, "\n  },\n");
+
+  /* --- Per worker breakdown --- */
+  fprintf(f, "  \"workers\": [");
+  for (i = 0; i < num_workers; i++)
+  {
+    const struct stats *s = stats_get(i);
+    uint64_t packets = STATS_READ(s, packets);
+
+    fprintf(f, "%s\n    { \"id\": %u, \"cpu\": %d, \"node\": %d, \"status\": \"%s\", ",
+      i ? "," : "",
+      i,
+      workers[i].cpu,
+      workers[i].node,
+      workers[i].status == EXIT_SUCCESS ? "success" : "failure");
+    fprintf(f, "\"packets\": %" PRIu64 ", \"bytes\": %" PRIu64 ", \"send_errors\": %" PRIu64 ", \"syscalls\": %" PRIu64 ", ",
+      packets,
+      STATS_READ(s, bytes),
+      STATS_READ(s, errors),
+      workers[i].syscalls);
+    fprintf(f, "\"cpu_s\": %.6f, ", workers[i].cpu_ns / 1e9);
+    json_rate(f, "\"cycles_per_packet\": ", packets ? workers[i].cpu_ns / 1e9 * tsc_hz / packets : 0);
+    fprintf(f, " }");
+  }
+  fprintf(f, "%s]\n", num_workers ? "\n  " : "");
+  fprintf(f, "}\n");
+
+  if (f != stdout)
+    if (fclose(f) == EOF)
+    {
+      fprintf(stderr, "%s: error writing report file '%s': %s\n", PACKAGE, filename, strerror(errno));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Writes a JSON string, escaping what must be escaped. */
+static void json_string(FILE *f, const char *s)
+{
+  fputc('"', f);
+
+  for (; *s; s++)
+    if (*s == '"' || *s == '\\')
+      fprintf(f, "\\%c", *s);
+    else if ((unsigned char)*s < 0x20)
+      fprintf(f, "\\u%04x", (unsigned char)*s);
+    else
+      fputc(*s, f);
+
+  fputc('"', f);
+}
+
+/* Writes a rate, or null if not set (zero). */
+static void json_rate(FILE *f, const char *prefix, double value)
+{
+  if (value > 0)
+    fprintf(f, "%s%.3f", prefix, value);
+  else
+    fprintf(f, "%snull", prefix);
+}
+
+static double tv_seconds(const struct timeval *tv)
+{
+  return tv->tv_sec + tv->tv_usec / 1e6;
+}
@@ -26,12 +26,116 @@
   extern FILE *fdebug;
 #endif
 
-/* Initialized for error condition, just in case! */
-static socket_t fd = -1;
+/* Initialized for error condition, just in case! 
+   NOTE: All the state below is private to each worker thread. */
+static __thread socket_t fd = -1;
 
-/* Socket configuration */
-int createSocket(void)
+/* Batched transmission state (used only if co->batch > 1). */
+struct batch_slot {
+  void *buffer;               /* private copy of the packet  */
+  size_t size;                /* allocated buffer size       */
+  struct sockaddr_in sin;     /* destination address         */
+};
+
+static __thread struct batch_slot *slots = NULL;
+static __thread struct mmsghdr *msgs = NULL;
+static __thread struct iovec *iovs = NULL;
+static __thread unsigned batch_size = 1;   /* slots available         */
+static __thread unsigned queued = 0;       /* slots waiting for flush */
+
+/* Counters used to report packets per system call at exit. */
+__thread uint64_t packets_sent = 0;
+__thread uint64_t syscalls_made = 0;
+
+static int  rawOpen(const struct config_options * const __restrict__, unsigned);
+static int  rawSend(const void * const, size_t, const struct config_options * const __restrict__);
+static int  rawFlush(void);
+static void rawClose(void);
+static int  setupBatch(unsigned);
+static int  nullOpen(const struct config_options * const __restrict__, unsigned);
+static int  nullSend(const void * const, size_t, const struct config_options * const __restrict__);
+static int  nullFlush(void);
+static void nullClose(void);
+
+/* Output backends, indexed by OUTPUT_* (see output.h). */
+const struct output_ops output_table[] = {
+  { "raw",    FALSE, NULL,        rawOpen,    rawSend,    rawFlush,    rawClose    },
+  { "packet", FALSE, packetSetup, packetOpen, packetSend, packetFlush, packetClose },
+  { "xdp",    FALSE, packetSetup, xdpOpen,    xdpSend,    xdpFlush,    xdpClose    },
+  { "uring",  FALSE, NULL,        uringOpen,  uringSend,  uringFlush,  uringClose  },
+  { "pcap",   TRUE,  pcapSetup,   pcapOpen,   pcapSend,   pcapFlush,   pcapClose   },
+  { "pcapng", TRUE,  pcapSetup,   pcapOpen,   pcapSend,   pcapFlush,   pcapClose   },
+  { "null",   TRUE,  NULL,        nullOpen,   nullSend,   nullFlush,   nullClose   },
+  { NULL }
+};
+
+/* Backend used by the worker. */
+static __thread const struct output_ops *out = &output_table[OUTPUT_RAW];
+
+/* Gets the backend index by name. Returns -1 if unknown. */
+int getOutputType(const char *name)
 {
+  int i;
+
+  for (i = 0; output_table[i].name != NULL; i++)
+    if (strcasecmp(name, output_table[i].name) == 0)
+      return i;
+
+  return -1;
+}
+
+/* Prepares the backend before the workers start (ex: resolving addresses). */
+int setupOutput(struct config_options * const __restrict__ co, const struct cidr *c)
+{
+  const struct output_ops *o = &output_table[co->output];
+
+  return o->setup ? o->setup(co, c) : TRUE;
+}
+
+/* Opens the output of worker 'id'. */
+int createSocket(const struct config_options * const __restrict__ co, unsigned id)
+{
+  out = &output_table[co->output];
+  return out->open(co, id);
+}
+
+void closeSocket(void)
+{
+  out->close();
+}
+
+/* Sends all packets still queued. */
+int flushPackets(void)
+{
+  return out->flush();
+}
+
+/* Returns how many packets and system calls were used so far. */
+void getSendCounters(uint64_t *packets, uint64_t *syscalls)
+{
+  *packets = packets_sent;
+  *syscalls = syscalls_made;
+}
+
+int sendPacket(const void * const buffer, size_t size, const struct config_options * const __restrict__ co)
+{
+  return out->send(buffer, size, co);
+}
+
+static int rawOpen(const struct config_options * const __restrict__ co, unsigned id)
+{
+  UNUSED_PARAM(id);
+
+  if ((fd = openRawSocket()) == -1)
+    return FALSE;
+
+  return setupBatch(co->batch);
+}
+
+/* Socket configuration. Returns -1 on error. */
+socket_t openRawSocket(void)
+{
+	socket_t fd;
 	socklen_t len;
 	unsigned n = 1, *nptr = &n;
 
@@ -39,14 +143,14 @@ int createSocket(void)
 	if( (fd = socket(AF_INET, SOCK_RAW, IPPROTO_RAW)) == -1 )
 	{
 		perror("error opening raw socket");
-		return FALSE;
+		return -1;
 	}
 
 	/* Setting IP_HDRINCL. */
 	if( setsockopt(fd, IPPROTO_IP, IP_HDRINCL, nptr, sizeof(n)) == -1 )
 	{
 		perror("error setting socket options");
-		return FALSE;
+		goto error;
 	}
 
 /* Taken from libdnet by Dug Song. */
@@ -56,7 +160,7 @@ int createSocket(void)
 	if ( getsockopt(fd, SOL_SOCKET, SO_SNDBUF, &n, &len) == -1 )
 	{
 		perror("error getting socket buffer");
-		return FALSE;
+		goto error;
 	}
 
 	/* Setting the maximum SO_SNDBUF in bytes.
@@ -71,7 +175,7 @@ int createSocket(void)
 				break;
 
 			perror("error setting socket buffer");
-			return FALSE;
+			goto error;
 		}
 	}
 #endif /* SO_SNDBUF */
@@ -81,7 +185,7 @@ int createSocket(void)
 	if( setsockopt(fd, SOL_SOCKET, SO_BROADCAST, nptr, sizeof(n)) == -1 )
 	{
 		perror("error setting socket broadcast");
-		return FALSE;
+		goto error;
 	}
 #endif /* SO_BROADCAST */
 
@@ -89,29 +193,161 @@ int createSocket(void)
 	if( setsockopt(fd, SOL_SOCKET, SO_PRIORITY, nptr, sizeof(n)) == -1 )
 	{
 		perror("error setting socket priority");
-		return FALSE;
+		goto error;
 	}
 #endif /* SO_PRIORITY */
 
-  return TRUE;
+  return fd;
+
+error:
+  close(fd);
+  return -1;
 }
 
-void closeSocket(void)
+static void rawClose(void)
 {
   if (fd != -1)
+  {
     close(fd);
+    fd = -1;
+  }
+
+  if (slots != NULL)
+  {
+    unsigned i;
+
+    for (i = 0; i < batch_size; i++)
+      free(slots[i].buffer);
+  }
+
+  free(slots);
+  free(msgs);
+  free(iovs);
+  slots = NULL;
+  msgs = NULL;
+  iovs = NULL;
+  queued = 0;
 }
 
-int sendPacket(const void * const buffer, size_t size, const struct config_options * const __restrict__ co)
+/* Allocates the mmsghdr/iovec vectors used by sendmmsg(). */
+static int setupBatch(unsigned n)
+{
+  unsigned i;
+
+  batch_size = n ? n : 1;
+
+  /* NOTE: batch_size == 1 uses the old sendto() path. */
+  if (batch_size == 1)
+    return TRUE;
+
+  slots = calloc(batch_size, sizeof(struct batch_slot));
+  msgs  = calloc(batch_size, sizeof(struct mmsghdr));
+  iovs  = calloc(batch_size, sizeof(struct iovec));
+
+  if (slots == NULL || msgs == NULL || iovs == NULL)
+  {
+    ERROR("Error allocating batch buffers");
+    return FALSE;
+  }
+
+  /* Linking each message to its own iovec and destination address.
+     These pointers don't change during the program lifetime. */
+  for (i = 0; i < batch_size; i++)
+  {
+    msgs[i].msg_hdr.msg_name    = &slots[i].sin;
+    msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+    msgs[i].msg_hdr.msg_iov     = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen  = 1;
+  }
+
+  return TRUE;
+}
+
+/* Sends all queued packets with as few sendmmsg() calls as possible. */
+static int rawFlush(void)
+{
+  unsigned done;
+  int num_tries;
+  int sent;
+
+  for (done = 0, num_tries = MAX_SENDTO_TRIES; done < queued && num_tries--;)
+  {
+    sent = sendmmsg(fd, msgs + done, queued - done, MSG_NOSIGNAL);
+    syscalls_made++;
+
+    if (sent == -1)
+    {
+      STATS_ERROR(errno);
+
+      /* Transient conditions: try again. */
+      if (errno == EPERM || errno == ENOBUFS || errno == EAGAIN || errno == EINTR)
+        continue;
+
+      break;
+    }
+
+    /* FIX: sendmmsg() may send only part of the vector (when the message
+            right after the last one sent fails). Keep going from there. */
+    packets_sent += sent;
+    STATS_ADD(packets, sent);
+    for (; sent > 0; sent--, done++)
+      STATS_ADD(bytes, iovs[done].iov_len);
+  }
+
+  if (done < queued)
+  {
+    ERROR("Error sending packet batch.");
+#ifdef DUMP_DATA
+    fprintf(fdebug, "Error sending batch (%u of %u packets sent).\n", done, queued);
+#endif
+    queued = 0;
+    return FALSE;
+  }
+
+  queued = 0;
+  return TRUE;
+}
+
+/* Queues a copy of the packet. The batch is flushed when full. */
+static int queuePacket(const void * const buffer, size_t size, const struct sockaddr_in *sin)
+{
+  struct batch_slot *slot = &slots[queued];
+
+  /* Grows slot buffer, if necessary. Since packet sizes don't vary much,
+     this happens only in the first few packets. */
+  if (size > slot->size)
+  {
+    void *p;
+
+    if ((p = realloc(slot->buffer, size)) == NULL)
+    {
+      ERROR("Error reallocating batch slot buffer");
+      return FALSE;
+    }
+
+    slot->buffer = p;
+    slot->size = size;
+  }
+
+  memcpy(slot->buffer, buffer, size);
+  slot->sin = *sin;
+  iovs[queued].iov_base = slot->buffer;
+  iovs[queued].iov_len  = size;
+
+  if (++queued == batch_size)
+    return rawFlush();
+
+  return TRUE;
+}
+
+static int rawSend(const void * const buffer, size_t size, const struct config_options * const __restrict__ co)
 {
   struct sockaddr_in sin = {};  /* zero fill */
   void *p;
   ssize_t sent;
   int num_tries;
 
-#ifdef DUMP_DATA
   size_t sz = size;
-#endif
 
   assert(buffer != NULL);
   assert(size > 0);
@@ -121,15 +357,31 @@ int sendPacket(const void * const buffer, size_t size, const struct config_optio
   sin.sin_port        = htons(IPPORT_RND(co->dest)); 
   sin.sin_addr.s_addr = co->ip.daddr; 
 
+  if (batch_size > 1)
+  {
+#ifdef DUMP_DATA
+    fprintf(fdebug, "Data queued:\n");
+    dump_buffer(fdebug, buffer, sz);
+#endif
+    return queuePacket(buffer, size, &sin);
+  }
+
   /* FIX: There is no garantee that sendto() will deliver the entire packet at once.
           So, we try MAX_SENDTO_TRIES times before giving up. */ 
   p = (void *)buffer;
   for (num_tries = MAX_SENDTO_TRIES; size > 0 && num_tries--;) 
   {
     sent = sendto(fd, p, size, MSG_NOSIGNAL, (struct sockaddr *)&sin, sizeof(struct sockaddr));
+    syscalls_made++;
 
     if (sent == -1)
     {
+      STATS_ERROR(errno);
+
+      /* NOTE: ENOBUFS means the device queue is full. Just try again. */
+      if (errno == ENOBUFS)
+        continue;
+
       if (errno != EPERM)
         goto error;
 
@@ -141,7 +393,6 @@ int sendPacket(const void * const buffer, size_t size, const struct config_optio
     p += sent;
   }
 
-
   /* FIX */
   if (num_tries < 0)
   {
@@ -159,5 +410,39 @@ error:
   dump_buffer(fdebug, buffer, sz);
 #endif
 
+  packets_sent++;
+  STATS_ADD(packets, 1);
+  STATS_ADD(bytes, sz);
+
+  return TRUE;
+}
+
+/* Null output: packets are built and dropped. Measures the builders alone. */
+static int nullOpen(const struct config_options * const __restrict__ co, unsigned id)
+{
+  UNUSED_PARAM(co);
+  UNUSED_PARAM(id);
+
+  return TRUE;
+}
+
+static int nullSend(const void * const buffer, size_t size, const struct config_options * const __restrict__ co)
+{
+  UNUSED_PARAM(buffer);
+  UNUSED_PARAM(co);
+
+  packets_sent++;
+  STATS_ADD(packets, 1);
+  STATS_ADD(bytes, size);
+
+  return TRUE;
+}
+
+static int nullFlush(void)
+{
   return TRUE;
 }
+
+static void nullClose(void)
+{
+}
@@ -0,0 +1,183 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <common.h>
+
+/* NOTE: Every thread sending packets must call stats_attach() first. */
+__thread struct stats *worker_stats = NULL;
+
+static struct stats *slots = NULL;
+static unsigned num_slots = 0;
+
+/* Reporter thread state. */
+static pthread_t reporter_tid;
+static pthread_mutex_t reporter_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t reporter_cond = PTHREAD_COND_INITIALIZER;
+static int reporter_running = FALSE;
+static double reporter_interval;
+
+static void *reporter_main(void *);
+
+/* Allocates one cache line aligned slot per worker. */
+struct stats *stats_alloc(unsigned n)
+{
+  if ((slots = aligned_alloc(CACHE_LINE_SIZE, n * sizeof(struct stats))) == NULL)
+  {
+    ERROR("Error allocating statistics");
+    return NULL;
+  }
+
+  memset(slots, 0, n * sizeof(struct stats));
+  num_slots = n;
+  return slots;
+}
+
+void stats_free(void)
+{
+  free(slots);
+  slots = NULL;
+  num_slots = 0;
+}
+
+/* Makes the calling thread the writer of slot 'id'. */
+void stats_attach(unsigned id)
+{
+  assert(id < num_slots);
+
+  worker_stats = &slots[id];
+}
+
+/* Sums all slots. Safe to call while workers are running. */
+void stats_sum(struct stats *total)
+{
+  unsigned i, j;
+
+  memset(total, 0, sizeof(struct stats));
+
+  for (i = 0; i < num_slots; i++)
+  {
+    total->packets += STATS_READ(&slots[i], packets);
+    total->bytes   += STATS_READ(&slots[i], bytes);
+    total->errors  += STATS_READ(&slots[i], errors);
+    total->enobufs += STATS_READ(&slots[i], enobufs);
+
+    for (j = 0; j < MAXIMUM_MODULES; j++)
+    {
+      total->proto[j]        += STATS_READ(&slots[i], proto[j]);
+      total->proto_bytes[j]  += STATS_READ(&slots[i], proto_bytes[j]);
+      total->proto_cycles[j] += STATS_READ(&slots[i], proto_cycles[j]);
+    }
+
+    for (j = 0; j < MAXIMUM_ERRNO; j++)
+      total->errnos[j] += STATS_READ(&slots[i], errnos[j]);
+  }
+}
+
+/* Gets the slot of worker 'id'. Read it with STATS_READ(). */
+const struct stats *stats_get(unsigned id)
+{
+  assert(id < num_slots);
+
+  return &slots[id];
+}
+
+/* Starts the thread printing rates every 'interval' seconds. */
+int startReporter(double interval)
+{
+  reporter_interval = interval;
+  reporter_running = TRUE;
+
+  if ((errno = pthread_create(&reporter_tid, NULL, reporter_main, NULL)) != 0)
+  {
+    perror("Error creating statistics reporter thread");
+    reporter_running = FALSE;
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+void stopReporter(void)
+{
+  pthread_mutex_lock(&reporter_mutex);
+  if (!reporter_running)
+  {
+    pthread_mutex_unlock(&reporter_mutex);
+    return;
+  }
+  reporter_running = FALSE;
+  pthread_cond_signal(&reporter_cond);
+  pthread_mutex_unlock(&reporter_mutex);
+
+  pthread_join(reporter_tid, NULL);
+}
+
+static void *reporter_main(void *arg)
+{
+  struct stats prev, cur;
+  struct timespec deadline;
+  uint64_t start, t0, t1;
+  double dt;
+
+  UNUSED_PARAM(arg);
+
+  stats_sum(&prev);
+  start = t0 = monotonic_ns();
+
+  /* NOTE: pthread_cond_timedwait() uses CLOCK_REALTIME by default. */
+  clock_gettime(CLOCK_REALTIME, &deadline);
+
+  pthread_mutex_lock(&reporter_mutex);
+  while (reporter_running)
+  {
+    deadline.tv_sec  += (time_t)reporter_interval;
+    deadline.tv_nsec += (long)((reporter_interval - (time_t)reporter_interval) * 1e9);
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+
+    /* Waits for the deadline or for stopReporter(). Spurious wakeups
+       wait again for the same deadline, so no interval is skipped. */
+    while (reporter_running &&
+           pthread_cond_timedwait(&reporter_cond, &reporter_mutex, &deadline) != ETIMEDOUT);
+
+    if (!reporter_running)
+      break;
+
+    stats_sum(&cur);
+    t1 = monotonic_ns();
+    dt = (t1 - t0) / 1e9;
+
+    printf("[%8.1fs] %12.0f pps %10.2f Mbps  (%" PRIu64 " packets, %" PRIu64 " errors, %" PRIu64 " ENOBUFS)\n",
+      (t1 - start) / 1e9,
+      (cur.packets - prev.packets) / dt,
+      (cur.bytes - prev.bytes) * 8 / dt / 1e6,
+      cur.packets,
+      cur.errors,
+      cur.enobufs);
+
+    prev = cur;
+    t0 = t1;
+  }
+  pthread_mutex_unlock(&reporter_mutex);
+
+  return NULL;
+}
@@ -18,16 +18,23 @@
 */
 
 #include <common.h>
-#include <sys/wait.h> /* POSIX.1 compliant */
 
 #ifdef DUMP_DATA
   FILE *fdebug;
   static unsigned long cnt = 1;
 #endif
 
-static pid_t pid = -1;      /* -1 is a trick used when __HAVE_TURBO__ isn't defined. */
+/* Set by the signal handler. Workers stop as soon as they see it. */
+static volatile sig_atomic_t stop = 0;
+
+/* Shared by all workers (read only). */
+static struct cidr *cidr_ptr;       /* Pointer to cidr host id and 1st ip address. */
+static struct targets *targets;     /* --targets-file ranges (or NULL). */
 
 static void initialize(void);
+static void *worker_main(void *);
+static void showPacingReport(const struct config_options *, const struct worker *, unsigned);
+static void showBuildReport(const struct run_times *);
 static const char *getOrdinalSuffix(unsigned);
 static const char *getMonth(unsigned);
 
@@ -35,17 +42,12 @@ static const char *getMonth(unsigned);
 int main(int argc, char *argv[])
 {
   struct config_options *co;  /* Pointer to options. */
-  struct cidr *cidr_ptr;      /* Pointer to cidr host id and 1st ip address. */
-  modules_table_t *ptbl;      /* Pointer to modules table */
-  uint8_t proto;              /* Used on main loop. */
-
-  /* This is a requirement of t50. User must be root to use it. 
-     Previously on checkConfigOptions(). */
-  if (getuid())
-  {
-    ERROR("User must have root priviledge to run.");
-    return EXIT_FAILURE;
-  }
+  struct worker *workers;     /* Worker threads states. */
+  struct run_times times;     /* Used by the report. */
+  unsigned num_workers = 1;   /* Number of workers. */
+  unsigned i;
+  int net_node = -1;          /* NUMA node of --interface. */
+  int status = EXIT_SUCCESS;
 
 #ifdef DUMP_DATA
   fdebug = fopen("t50-debug.log", "wt");
@@ -61,57 +63,140 @@ int main(int argc, char *argv[])
   if (!checkConfigOptions(co))
     return EXIT_FAILURE;
 
-  /* Setting socket file descriptor. */
-  /* NOTE: createSocket() handles its own errors before returning. */
-  if (!createSocket())
+  /* This is a requirement of t50. User must be root to use it,
+     unless the packets don't go to the network. */
+  if (getuid() && !output_table[co->output].offline)
+  {
+    ERROR("User must have root priviledge to run.");
     return EXIT_FAILURE;
+  }
 
-  /* Setup random seed using current date/time timestamp. */
+  /* Setup random seed using current date/time timestamp, unless given. */
   /* NOTE: Random seed don't need to be so precise! */
-  SRANDOM(time(NULL));
+  SRANDOM(co->seed_set ? co->seed : (uint64_t)time(NULL));
+
+  cksum_init();
+  random_init();
+
+  /* --port-mode PERMUTE: one shuffle, new each run (or fixed by --seed). */
+  if (co->port_mode == DEST_PERMUTE)
+  {
+    if (co->num_sports)
+      shufflePorts(co->sport_list, co->num_sports);
+    if (co->num_dports)
+      shufflePorts(co->dport_list, co->num_dports);
+  }
+
+  /* Workers sending through an interface go to the cores of its NUMA
+     node, unless --cpus says otherwise (then they are only checked, below). */
+  if (co->interface != NULL && (net_node = getNetNode(co->interface)) >= 0 && !co->num_cpus)
+    getNodeCpus(net_node, &co->cpu_list, &co->num_cpus);
 
 #ifdef  __HAVE_TURBO__
-  /* Entering in TURBO. */
-  if (co->turbo)
+  /* Entering in TURBO: one worker per listed (or online) CPU, unless told otherwise. */
+  num_workers = co->workers;
+  if (co->turbo && num_workers == 1)
   {
-    /* Decides if it's necessary to fork a new process. */
-    if ((co->ip.protocol == IPPROTO_T50 && co->threshold > (threshold_t)getNumberOfRegisteredModules()) || 
-        (co->ip.protocol != IPPROTO_T50 && co->threshold > 1))
+    long n = co->num_cpus ? (long)co->num_cpus : sysconf(_SC_NPROCESSORS_ONLN);
+
+    num_workers = (n > 1) ? (n < MAXIMUM_WORKERS ? n : MAXIMUM_WORKERS) : 1;
+  }
+
+  /* FIX: Don't create workers without packets to send. */
+  if (!co->flood && (threshold_t)num_workers > co->threshold)
+    num_workers = co->threshold;
+
+  /* Setting the priority to highly favorable scheduling value. */
+  /* FIXME: Why not setup this value when t50 runs a single worker? */
+  if (num_workers > 1)
+    if (setpriority(PRIO_PROCESS, PRIO_PROCESS, -15)  == -1)
     {
-      threshold_t new_threshold;
+      perror("Error setting process priority. Exiting...");
+      return EXIT_FAILURE;
+    }
+#endif  /* __HAVE_TURBO__ */
 
-      if ((pid = fork()) == -1)
-      {
-        perror("Error creating child process. Exiting...");
-        return EXIT_FAILURE;
-      }
+  /* Workers see how many they are (ex: to split rates). */
+  co->workers = num_workers;
 
-      /* Setting the priority to both parent and child process to highly favorable scheduling value. */
-      /* FIXME: Why not setup this value when t50 runs as a single process? */
-      if (setpriority(PRIO_PROCESS, PRIO_PROCESS, -15)  == -1)
-      {
-        perror("Error setting process priority. Exiting...");
-        return EXIT_FAILURE;
-      }
+  /* Loads the targets file. Its first address stands for the target where
+     only one is used (ex: next hop lookup). */
+  if (co->targets_file != NULL)
+  {
+    if ((targets = targets_load(co->targets_file)) == NULL)
+      return EXIT_FAILURE;
 
-      /* Divide the process iterations in main loop between processes. */
-      new_threshold = co->threshold / 2; 
+    co->ip.daddr = htonl(targets->range[0].first);
+  }
 
-      /* FIX: Ooops! Parent process get the extra packet, if given threshold is odd. */
-      if ((co->threshold % 2) && !IS_CHILD_PID(pid))
-        new_threshold++;
+  /* Calculates CIDR for destination address. */
+  if ((cidr_ptr = config_cidr(co->bits, co->ip.daddr, co->range_end, targets)) == NULL)
+    return EXIT_FAILURE;
 
-      co->threshold = new_threshold;
+  /* Every worker needs its share of the flow pool. */
+  if (co->flows)
+  {
+    if (co->flows < num_workers)
+    {
+      ERROR("--flows must be at least the number of workers");
+      return EXIT_FAILURE;
     }
+
+    if (!flows_init(co))
+      return EXIT_FAILURE;
   }
-#endif  /* __HAVE_TURBO__ */
 
-  /* Calculates CIDR for destination address. */
-  if ((cidr_ptr = config_cidr(co->bits, co->ip.daddr)) == NULL)
+  /* Output backend preparation (ex: next hop MAC for AF_PACKET). */
+  if (!setupOutput(co, cidr_ptr))
+    return EXIT_FAILURE;
+
+  if ((workers = calloc(num_workers, sizeof(struct worker))) == NULL)
+  {
+    ERROR("Error allocating workers");
+    return EXIT_FAILURE;
+  }
+
+  /* Builds the protocol mix sampling tables (shared by all workers). */
+  if (co->mix_weights != NULL)
+    if (!mix_init(co->mix_weights))
+      return EXIT_FAILURE;
+
+  /* One statistics slot per worker. */
+  if (stats_alloc(num_workers) == NULL)
     return EXIT_FAILURE;
 
-  /* Show launch info only for parent process. */
-  if (!IS_CHILD_PID(pid))
+  /* Divide the main loop iterations between workers.
+     FIX: The first 'threshold % num_workers' workers get one extra packet,
+          so no packet is lost (or added). */
+  for (i = 0; i < num_workers; i++)
+  {
+    workers[i].id = i;
+    workers[i].co = *co;
+    workers[i].co.threshold = co->threshold / num_workers +
+                              ((threshold_t)i < co->threshold % (threshold_t)num_workers);
+
+    /* Cores are assigned round robin. */
+    workers[i].cpu = co->num_cpus ? co->cpu_list[i % co->num_cpus] : -1;
+    workers[i].node = co->num_cpus ? getCpuNode(workers[i].cpu) : -1;
+
+    pacer_init(&workers[i].pacer, co, num_workers);
+
+    /* Workers start evenly spaced on the mix schedule. */
+    workers[i].mix_pos = i * (MIX_SCHEDULE_SIZE / num_workers);
+
+    /* Worker N takes hosts N, N + workers, ... (--dest-mode). */
+    workers[i].dest_pos = cidr_ptr->hostid ? i % cidr_ptr->hostid : 0;
+    workers[i].dest_range = 0;
+    workers[i].sport_pos = co->num_sports ? i % co->num_sports : 0;
+    workers[i].dport_pos = co->num_dports ? i % co->num_dports : 0;
+
+    /* NOTE: Crossing nodes costs on every frame, but it may be wanted. */
+    if (net_node >= 0 && workers[i].node >= 0 && workers[i].node != net_node)
+      fprintf(stderr, "%s: warning: worker %u is on NUMA node %d, %s is on node %d\n",
+              PACKAGE, i, workers[i].node, co->interface, net_node);
+  }
+
+  /* Show launch info. */
   {
     time_t lt;
     struct tm *tm;
@@ -130,7 +215,166 @@ int main(int argc, char *argv[])
       tm->tm_hour, 
       tm->tm_min, 
       tm->tm_sec);
+
+    if (num_workers > 1)
+      printf("Running %u workers\n", num_workers);
+
+    /* Shows the placement chosen for each worker. */
+    if (co->num_cpus)
+    {
+      for (i = 0; i < num_workers; i++)
+      {
+        if (workers[i].node >= 0)
+          printf("Worker %u pinned to CPU %d (NUMA node %d)\n", i, workers[i].cpu, workers[i].node);
+        else
+          printf("Worker %u pinned to CPU %d\n", i, workers[i].cpu);
+      }
+    }
+  }
+
+  /* NOTE: The reporter only reads the slots. Failing to start it isn't fatal. */
+  if (co->stats_interval > 0)
+    startReporter(co->stats_interval);
+
+  times.wall_ns = monotonic_ns();
+  times.tsc_cycles = read_tsc();
+
+  /* A single worker runs on the main thread, as always. */
+  if (num_workers == 1)
+    worker_main(workers);
+  else
+  {
+    for (i = 0; i < num_workers; i++)
+      if ((errno = pthread_create(&workers[i].tid, NULL, worker_main, &workers[i])) != 0)
+      {
+        perror("Error creating worker thread");
+
+        /* Stop the workers already running. */
+        stop = -1;
+        num_workers = i;
+        status = EXIT_FAILURE;
+        break;
+      }
+
+    for (i = 0; i < num_workers; i++)
+      pthread_join(workers[i].tid, NULL);
+  }
+
+  times.wall_ns = monotonic_ns() - times.wall_ns;
+  times.tsc_cycles = read_tsc() - times.tsc_cycles;
+
+  stopReporter();
+
+  /* Show termination message. */
+  {
+    time_t lt;
+    struct tm *tm;
+    uint64_t packets = 0, syscalls = 0;
+
+    for (i = 0; i < num_workers; i++)
+    {
+      if (workers[i].status != EXIT_SUCCESS)
+        status = EXIT_FAILURE;
+
+      packets += workers[i].packets;
+      syscalls += workers[i].syscalls;
+    }
+
+    /* Batch mode: shows how well the send system calls were amortized. */
+    if (co->batch > 1)
+      printf("\b\n%" PRIu64 " packets sent in %" PRIu64 " system calls (%.2f packets/call)\n",
+        packets,
+        syscalls,
+        syscalls ? (double)packets / syscalls : 0.0);
+
+    if (co->pps > 0 || co->bps > 0)
+      showPacingReport(co, workers, num_workers);
+
+    if (co->output == OUTPUT_NULL)
+      showBuildReport(&times);
+
+    /* Final statistics, if live statistics were asked for. */
+    if (co->stats_interval > 0)
+    {
+      struct stats total;
+
+      stats_sum(&total);
+      printf("\b\n%" PRIu64 " packets (%" PRIu64 " bytes) sent, %" PRIu64 " send errors (%" PRIu64 " ENOBUFS)\n",
+        total.packets,
+        total.bytes,
+        total.errors,
+        total.enobufs);
+    }
+
+    if (co->report_file != NULL)
+      if (!writeReport(co->report_file, co, workers, num_workers, &times))
+        status = EXIT_FAILURE;
+
+    /* Getting the local time. */
+    lt = time(NULL); 
+    tm = localtime(&lt);
+
+    printf("\b\n%s %s %s at %s %2d%s %d %.02d:%.02d:%.02d\n",
+      PACKAGE,
+      VERSION,
+      status == EXIT_SUCCESS ? "successfully finished" : "finished with errors",
+      getMonth(tm->tm_mon),
+      tm->tm_mday,
+      getOrdinalSuffix(tm->tm_mday),
+      (tm->tm_year + 1900),
+      tm->tm_hour,
+      tm->tm_min,
+      tm->tm_sec);
+  }
+
+  free(workers);
+  stats_free();
+  mix_free();
+
+#ifdef DUMP_DATA
+  fclose(fdebug);
+#endif
+
+  /* FIX: The shell documentation (bash) specifies that a process
+          when exits because a signal, must return 128+signal#. */
+  if (stop > 0)
+    return 128 + stop;
+
+  return status;
+}
+
+/* The main loop. Runs on each worker thread. */
+static void *worker_main(void *arg)
+{
+  struct worker *w = arg;
+  struct config_options *co = NULL;
+  modules_table_t *ptbl;      /* Pointer to modules table */
+  uint8_t proto;              /* Used on main loop. */
+  int pacing = (w->co.pps > 0 || w->co.bps > 0) && !output_table[w->co.output].offline;
+  int profile = w->co.output == OUTPUT_NULL;
+  uint64_t index = w->id;     /* Packet number (--seed): workers interleave. */
+
+  /* Pinning must happen before any allocation, so the worker memory
+     lives on the NUMA node of its core. */
+  if (w->cpu >= 0)
+    if (!setThreadPlacement(w->cpu, w->node))
+      goto error;
+
+  stats_attach(w->id);
+  random_attach(w->id);
+
+  /* Worker's own copy of the options (first touched here). */
+  if ((co = malloc(sizeof(struct config_options))) == NULL)
+  {
+    ERROR("Error allocating worker options");
+    goto error;
   }
+  *co = w->co;
+
+  /* Setting socket file descriptor. */
+  /* NOTE: createSocket() handles its own errors before returning. */
+  if (!createSocket(co, w->id))
+    goto error;
 
   /* Selects the initial protocol to use. */
   proto = co->ip.protocol;
@@ -141,106 +385,206 @@ int main(int argc, char *argv[])
   /* Preallocate packet buffer. */
   alloc_packet(INITIAL_PACKET_SIZE);
 
+  /* Worker share of the flow pool (--flows). */
+  if (co->flows)
+    if (!flows_create(&w->flows, &w->co, cidr_ptr, w->id, co->workers))
+      goto error;
+
   /* Execute if flood or while threshold greater than 0. */
-  while (co->flood || (co->threshold-- > 0))
+  while (!stop && (co->flood || (co->threshold-- > 0)))
   {
     /* Holds the actual packet size after module function call. */
     size_t size;
+    uint64_t tsc = 0;
 
 #ifdef DUMP_DATA
     fprintf(fdebug, "*** Packet #%u\n", cnt++);
 #endif
 
-    /* Set the destination IP address to RANDOM IP address. */
-    /* NOTE: The previous code did not account for 'hostid == 0'! */
-    co->ip.daddr = cidr_ptr->__1st_addr;
-    if (cidr_ptr->hostid)
-      co->ip.daddr += RANDOM() % cidr_ptr->hostid;
-    co->ip.daddr = htonl(co->ip.daddr);
+    /* Reproducible runs: everything drawn for this packet (and the module
+       picked) depends only on the seed and the packet number. */
+    if (co->seed_set)
+    {
+      random_packet(index);
+
+      if (co->mix_weights != NULL && co->mix_schedule)
+        w->mix_pos = index;
+      else if (proto == IPPROTO_T50 && co->mix_weights == NULL)
+        ptbl = mod_table + index % getNumberOfRegisteredModules();
+    }
+
+    /* Flow pool: the flow gives addresses and ports. Otherwise, set the
+       destination IP address (--dest-mode) and the ports of the lists
+       (--port-mode), seen alike by the modules and sendPacket(). */
+    if (co->flows)
+    {
+      if (co->flow_churn > 0)
+        flows_churn(&w->flows);
+
+      flow_next(&w->flows, co, index);
+    }
+    else
+    {
+      co->ip.daddr = htonl(cidr_address(cidr_ptr, co->dest_mode, &w->dest_pos, &w->dest_range, co->workers));
+
+      if (co->num_sports)
+        co->source = port_next(co->sport_list, co->num_sports, co->port_mode, &w->sport_pos, co->workers);
+      if (co->num_dports)
+        co->dest = port_next(co->dport_list, co->num_dports, co->port_mode, &w->dport_pos, co->workers);
+    }
+
+    index += co->workers;
+
+    /* Weighted mix: picks the module for this packet. */
+    if (co->mix_weights != NULL)
+      ptbl = mod_table + (co->mix_schedule ? mix_next_scheduled(&w->mix_pos) : mix_next_alias());
 
     /* Calls the 'module' function and sends the packet. */
     co->ip.protocol = ptbl->protocol_id;
-    ptbl->func(co, &size);
+    if (profile)
+      tsc = read_tsc();
+
+    if (co->no_template)
+      ptbl->func(co, &size);
+    else
+      template_build(ptbl - mod_table, co, &size);
+
+    /* Null output: cycles spent building, per module. */
+    if (profile)
+      STATS_ADD(proto_cycles[ptbl - mod_table], read_tsc() - tsc);
+
+    /* Rate limiting, if asked for. */
+    if (pacing)
+      pacer_wait(&w->pacer, size);
 
     if (!sendPacket(packet, size, co))
-      return EXIT_FAILURE;
+      goto error;
+
+    STATS_ADD(proto[ptbl - mod_table], 1);
+    STATS_ADD(proto_bytes[ptbl - mod_table], size);
   
     /* If protocol if 'T50', then get the next true protocol. */
-    if (proto == IPPROTO_T50)
+    if (proto == IPPROTO_T50 && co->mix_weights == NULL)
       if ((++ptbl)->func == NULL)
         ptbl = mod_table;
   }
 
-  /* Show termination message only for parent process. */
-  if (!IS_CHILD_PID(pid))
+  /* Sends whatever is still queued on batch mode. */
+  if (!flushPackets())
+    goto error;
+
+  w->status = EXIT_SUCCESS;
+
+finish:
   {
-    time_t lt;
-    struct tm *tm;
+    struct timespec ts;
 
-#ifdef  __HAVE_TURBO__
-    int status;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+      w->cpu_ns = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+  }
 
-    /* Wait 5 seconds for child process, then ungracefully closes the program. */
-    alarm(5);
-    wait(&status);
-#endif
+  getSendCounters(&w->packets, &w->syscalls);
+  closeSocket();
+  template_free();
+  free_packet();
+  flows_destroy(&w->flows);
+  free(co);
+  return NULL;
+
+error:
+  /* One worker failing stops the others. */
+  w->status = EXIT_FAILURE;
+  if (!stop)
+    stop = -1;
+  goto finish;
+}
 
-    /* FIX: To graciously end the program, only the parent process can close the socket. 
-       NOTE: I realize that closing descriptors are reference counted.
-             Kept the logic just in case! */
-    closeSocket();
+/* Shows requested versus achieved rates. */
+static void showPacingReport(const struct config_options *co, const struct worker *workers, unsigned num_workers)
+{
+  double start = 0, end = 0, elapsed;
+  uint64_t packets = 0, bits = 0;
+  unsigned i;
 
-    /* Getting the local time. */
-    lt = time(NULL); 
-    tm = localtime(&lt);
+  for (i = 0; i < num_workers; i++)
+  {
+    const struct pacer *p = &workers[i].pacer;
+    double last;
 
-    printf("\b\n%s %s successfully finished at %s %2d%s %d %.02d:%.02d:%.02d\n",
-      PACKAGE,
-      VERSION,
-      getMonth(tm->tm_mon),
-      tm->tm_mday,
-      getOrdinalSuffix(tm->tm_mday),
-      (tm->tm_year + 1900),
-      tm->tm_hour,
-      tm->tm_min,
-      tm->tm_sec);
+    if (p->packets == 0)
+      continue;
+
+    /* NOTE: The interval ends when the bucket would allow the next packet,
+             so the last packet sent is accounted for. */
+    last = (p->next > p->last) ? p->next : p->last;
+
+    if (packets == 0 || p->start < start)
+      start = p->start;
+    if (last > end)
+      end = last;
+
+    packets += p->packets;
+    bits += p->bits;
   }
 
-#ifdef DUMP_DATA
-  fclose(fdebug);
-#endif
+  if (packets == 0 || end <= start)
+    return;
 
+  elapsed = (end - start) / 1e9;
 
-  return 0;
+  if (co->pps > 0)
+    printf("\b\nRequested %.0f pps, achieved %.0f pps (pacing error %+.3f%%)\n",
+      co->pps,
+      packets / elapsed,
+      100.0 * (packets / elapsed - co->pps) / co->pps);
+
+  if (co->bps > 0)
+    printf("\b\nRequested %.0f bps, achieved %.0f bps (pacing error %+.3f%%)\n",
+      co->bps,
+      bits / elapsed,
+      100.0 * (bits / elapsed - co->bps) / co->bps);
 }
 
-/* This function handles interruptions. */
-static void signal_handler(int signal)
+/* Shows the build rate of each module (--output null). The rate of a module
+   is how fast a worker builds its packets, alone. */
+static void showBuildReport(const struct run_times *times)
 {
-  /* Make sure the socket descriptor is closed. 
-     FIX: But only if this is the parent process. Closing the cloned descriptor on the
-          child process can be catastrophic to the parent. 
-     NOTE: I realize that the act of closing descriptors are reference counted.
-           Keept the logic just in case! */
-
-  /* Ignore the SIGALRM. Used only to timeout the wait() function! */
-  if (signal == SIGALRM)
-    return;
+  struct stats total;
+  double wall = times->wall_ns / 1e9;
+  double tsc_hz = wall > 0 ? times->tsc_cycles / wall : 0;
+  unsigned i;
+
+  stats_sum(&total);
 
-#ifdef __HAVE_TURBO__
-  if (!IS_CHILD_PID(pid))
+  printf("\b\n%-8s %14s %14s %14s\n", "Module", "Packets", "Packets/s", "Cycles/packet");
+  for (i = 0; mod_table[i].func != NULL && i < MAXIMUM_MODULES; i++)
   {
-    /* Kills the child process! */
-    kill(pid, SIGKILL);
-#endif
-    closeSocket();
-#ifdef __HAVE_TURBO__
+    double cycles;
+
+    if (total.proto[i] == 0)
+      continue;
+
+    cycles = (double)total.proto_cycles[i] / total.proto[i];
+    printf("%-8s %14" PRIu64 " %14.0f %14.1f\n",
+      mod_table[i].acronym,
+      total.proto[i],
+      cycles > 0 ? tsc_hz / cycles : 0,
+      cycles);
   }
-#endif
 
-  /* FIX: The shell documentation (bash) specifies that a process
-          when exits because a signal, must return 128+signal#. */
-  exit(128 + signal);
+  if (wall > 0)
+    printf("%-8s %14" PRIu64 " %14.0f\n", "Total", total.packets, total.packets / wall);
+}
+
+/* This function handles interruptions. */
+static void signal_handler(int signal)
+{
+  /* The first signal asks the workers to finish (they close their own
+     sockets). If they don't, a second signal terminates the program. */
+  if (stop > 0)
+    _exit(128 + signal);
+
+  stop = signal;
 }
 
 static void initialize(void)
@@ -255,7 +599,7 @@ static void initialize(void)
   sa.sa_flags = SA_RESTART; /* same signal() semantics?! */
 
   /* Trap all "interrupt" signals, except SIGKILL, SIGSTOP and SIGSEGV (uncatchable, accordingly to 'man 7 signal'). 
-     This is necessary to close the socket when terminating the parent process. */
+     This is necessary to stop the workers gracefully. */
   sa.sa_handler = signal_handler;
   sigaction(SIGHUP,  &sa, NULL);
   sigaction(SIGPIPE, &sa, NULL);
@@ -265,14 +609,6 @@ static void initialize(void)
   sigaction(SIGTRAP, &sa, NULL);
   sigaction(SIGTERM, &sa, NULL);
   sigaction(SIGTSTP, &sa, NULL);
-#ifdef  __HAVE_TURBO__
-  /* FIX: Is it wise to simply terminate the main process
-          if the child terminates? 
-
-          Maybe it is wiser if we implement some kind of
-          timeout when waiting for the child to terminate. */
-  sigaction(SIGALRM, &sa, NULL);
-#endif
 
   /* --- Make sure stdout is unbuffered (otherwise, it's line buffered). --- */
   fflush(stdout);
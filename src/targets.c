@@ -0,0 +1,351 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Targets file (--targets-file): one address or CIDR per line, blank lines
+   and '#' comments allowed. The file is mapped and parsed just once, on the
+   main thread; the workers only see the range table built from it. */
+
+#include <common.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* A parsed entry: addresses first to last, both included (host order). */
+struct interval {
+  uint32_t first, last;
+};
+
+static int parseEntry(const char **, const char *, struct interval *);
+static int compareIntervals(const void *, const void *);
+static uint64_t countSlots(const struct interval *, size_t, unsigned);
+static struct targets *buildTable(struct interval *, size_t);
+static int buildAlias(struct targets *);
+
+/* Loads the targets. Returns NULL (and tells why) on error. */
+struct targets *targets_load(const char *name)
+{
+  struct interval *iv = NULL;
+  struct targets *t;
+  struct stat st;
+  size_t n = 0, size = 0;
+  const char *p, *end;
+  unsigned line = 1;
+  void *map;
+  int fd;
+
+  if ((fd = open(name, O_RDONLY)) == -1 || fstat(fd, &st) == -1)
+  {
+    fprintf(stderr, "%s: error opening %s: %s\n", PACKAGE, name, strerror(errno));
+    if (fd != -1)
+      close(fd);
+    return NULL;
+  }
+
+  if (st.st_size == 0)
+  {
+    fprintf(stderr, "%s: no targets on %s\n", PACKAGE, name);
+    close(fd);
+    return NULL;
+  }
+
+  map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED)
+  {
+    fprintf(stderr, "%s: error mapping %s: %s\n", PACKAGE, name, strerror(errno));
+    return NULL;
+  }
+  madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+  for (p = map, end = p + st.st_size; p < end;)
+  {
+    switch (*p)
+    {
+      case '\n':
+        line++;
+        /* fall through */
+      case ' ':
+      case '\t':
+      case '\r':
+        p++;
+        continue;
+
+      case '#':
+        while (p < end && *p != '\n')
+          p++;
+        continue;
+    }
+
+    if (n == size)
+    {
+      struct interval *q;
+
+      size = size ? 2 * size : 4096;
+      if ((q = realloc(iv, size * sizeof(struct interval))) == NULL)
+      {
+        ERROR("Error allocating targets");
+        goto fail;
+      }
+      iv = q;
+    }
+
+    if (!parseEntry(&p, end, &iv[n++]))
+    {
+      fprintf(stderr, "%s: %s:%u: bad address or CIDR\n", PACKAGE, name, line);
+      goto fail;
+    }
+  }
+
+  munmap(map, st.st_size);
+  map = NULL;
+
+  if (n == 0)
+  {
+    fprintf(stderr, "%s: no targets on %s\n", PACKAGE, name);
+    goto fail;
+  }
+
+  if ((t = buildTable(iv, n)) == NULL)
+    goto fail;
+
+  free(iv);
+  return t;
+
+fail:
+  if (map != NULL)
+    munmap(map, st.st_size);
+  free(iv);
+  return NULL;
+}
+
+/* Parses "a.b.c.d[/bits]" up to a blank or a comment. Like the target on
+   the command line, a CIDR doesn't include its network and broadcast
+   addresses, except /31 (RFC 3021) and /32. */
+static int parseEntry(const char **pp, const char *end, struct interval *iv)
+{
+  const char *p = *pp;
+  uint32_t addr = 0, mask;
+  unsigned bits = 32, v;
+  int i, d;
+
+  for (i = 0; i < 4; i++)
+  {
+    if (i > 0 && (p >= end || *p++ != '.'))
+      return FALSE;
+
+    for (v = 0, d = 0; p < end && *p >= '0' && *p <= '9' && d < 3; p++, d++)
+      v = v * 10 + *p - '0';
+    if (d == 0 || v > 255)
+      return FALSE;
+
+    addr = addr << 8 | v;
+  }
+
+  if (p < end && *p == '/')
+  {
+    for (p++, bits = 0, d = 0; p < end && *p >= '0' && *p <= '9' && d < 2; p++, d++)
+      bits = bits * 10 + *p - '0';
+    if (d == 0 || bits > CIDR_MAXIMUM)
+      return FALSE;
+  }
+
+  if (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n' && *p != '#')
+    return FALSE;
+  *pp = p;
+
+  mask = bits ? 0xffffffffU << (32 - bits) : 0;
+  iv->first = addr & mask;
+  iv->last = addr | ~mask;
+  if (bits < 31)
+  {
+    iv->first++;
+    iv->last--;
+  }
+
+  return TRUE;
+}
+
+static int compareIntervals(const void *a, const void *b)
+{
+  uint32_t x = ((const struct interval *)a)->first;
+  uint32_t y = ((const struct interval *)b)->first;
+
+  return (x > y) - (x < y);
+}
+
+/* Places needed by the ranges on buckets of 2^shift. */
+static uint64_t countSlots(const struct interval *iv, size_t n, unsigned shift)
+{
+  uint64_t slots = 0;
+  size_t i;
+
+  for (i = 0; i < n; i++)
+    slots += (((uint64_t)(iv[i].last - iv[i].first) >> shift) + 1) << shift;
+
+  return slots;
+}
+
+/* Sorts and merges the intervals, then builds the ranges, the buckets and
+   the alias tables. */
+static struct targets *buildTable(struct interval *iv, size_t n)
+{
+  struct targets *t;
+  uint64_t total = 0, slots;
+  uint32_t b;
+  size_t i, m;
+
+  qsort(iv, n, sizeof(struct interval), compareIntervals);
+
+  /* NOTE: 'last + 1' only wraps when 'last' is 255.255.255.255, but then
+           the first test is already true. */
+  for (m = 0, i = 1; i < n; i++)
+    if (iv[i].first <= iv[m].last || iv[i].first == iv[m].last + 1)
+    {
+      if (iv[i].last > iv[m].last)
+        iv[m].last = iv[i].last;
+    }
+    else
+      iv[++m] = iv[i];
+  n = m + 1;
+
+  for (i = 0; i < n; i++)
+    total += (uint64_t)(iv[i].last - iv[i].first) + 1;
+
+  if (total > UINT32_MAX)
+  {
+    ERROR("targets cover the whole address space");
+    return NULL;
+  }
+
+  if ((t = calloc(1, sizeof(struct targets))) == NULL ||
+      (t->range = malloc((n + 1) * sizeof(struct target_range))) == NULL)
+    goto fail;
+
+  t->n = n;
+  t->total = total;
+
+  /* The widest buckets whose padding (less than a bucket per range) is
+     not over the hosts: then there are at most about three buckets per
+     range, and the permutation passes over a place of padding for each
+     host at most. Narrower ones if the places don't fit 32 bits (there is
+     no padding at all on buckets of 1). */
+  for (t->shift = 0; t->shift < 31 && ((uint64_t)n << (t->shift + 1)) - n <= total; t->shift++);
+  while ((slots = countSlots(iv, n, t->shift)) > UINT32_MAX)
+    t->shift--;
+  t->slots = slots;
+
+  if ((t->bucket = malloc((slots >> t->shift) * sizeof(struct target_bucket))) == NULL)
+    goto fail;
+
+  for (i = 0, b = 0, total = 0; i < n; i++)
+  {
+    uint64_t left = (uint64_t)(iv[i].last - iv[i].first) + 1;
+    in_addr_t first = iv[i].first;
+
+    t->range[i].start = total;
+    t->range[i].first = first;
+    t->range[i].slot = (uint64_t)b << t->shift;
+    total += left;
+
+    for (; left > 0; b++)
+    {
+      uint32_t count = left < 1ULL << t->shift ? left : 1ULL << t->shift;
+
+      t->bucket[b].first = first;
+      t->bucket[b].count = count;
+      first += count;
+      left -= count;
+    }
+  }
+
+  t->range[n].start = total;
+  t->range[n].first = 0;
+  t->range[n].slot = slots;
+
+  if (buildAlias(t))
+    return t;
+
+fail:
+  ERROR("Error allocating targets");
+  if (t != NULL)
+  {
+    free(t->range);
+    free(t->bucket);
+  }
+  free(t);
+  return NULL;
+}
+
+/* Alias tables (Vose, like the --flow-mode ZIPF ones) for the range
+   weights. Small columns are stacked from the start of 'stack', large
+   ones from its end. */
+static int buildAlias(struct targets *t)
+{
+  uint32_t n = t->n, ns = 0, nl = 0, i, *stack;
+  double *scaled;
+
+  scaled = malloc(n * sizeof(double));
+  stack = malloc(n * sizeof(uint32_t));
+  if (scaled == NULL || stack == NULL)
+  {
+    free(scaled);
+    free(stack);
+    return FALSE;
+  }
+
+  for (i = 0; i < n; i++)
+  {
+    scaled[i] = (double)(t->range[i + 1].start - t->range[i].start) * n / t->total;
+    if (scaled[i] < 1.0)
+      stack[ns++] = i;
+    else
+      stack[n - ++nl] = i;
+  }
+
+  while (ns && nl)
+  {
+    uint32_t s = stack[--ns], l = stack[n - nl--];
+
+    t->range[s].prob  = (uint32_t)(scaled[s] * 2147483648.0);
+    t->range[s].alias = l;
+
+    scaled[l] -= 1.0 - scaled[s];
+    if (scaled[l] < 1.0)
+      stack[ns++] = l;
+    else
+      stack[n - ++nl] = l;
+  }
+
+  /* NOTE: Whatever is left is (up to rounding) exactly 1. */
+  while (nl)
+  {
+    i = stack[n - nl--];
+    t->range[i].prob  = 0x80000000U;
+    t->range[i].alias = i;
+  }
+  while (ns)
+  {
+    i = stack[--ns];
+    t->range[i].prob  = 0x80000000U;
+    t->range[i].alias = i;
+  }
+
+  free(scaled);
+  free(stack);
+  return TRUE;
+}
@@ -0,0 +1,354 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <common.h>
+
+/* Template states. */
+enum { TEMPLATE_NEW = 0, TEMPLATE_READY, TEMPLATE_UNSUPPORTED };
+
+/* Templates of one module. */
+struct template_slot {
+  int       state;
+  unsigned  (*key_fn)(uint32_t);              /* NULL if only one layout */
+  uint8_t   ready[TEMPLATE_MAX_VARIANTS];
+  struct template variants[TEMPLATE_MAX_VARIANTS];
+};
+
+/* NOTE: All the state below is private to each worker thread. */
+__thread struct template_rec *template_rec = NULL;
+
+static __thread struct template_slot slots[MAXIMUM_MODULES];
+
+/* Template whose packet is on the packet buffer right now. Its constant
+   bytes don't need to be copied again. */
+static __thread const struct template *last_template = NULL;
+
+static struct template_op *add_op(int, const void *, size_t);
+static int  render(struct template_slot *, unsigned, const struct config_options * const __restrict__, size_t *, int, uint32_t);
+static void apply(const struct template *, const struct config_options * const __restrict__, uint32_t);
+static void prune(struct template *);
+static unsigned op_width(const struct template_op *);
+static void release(struct template *);
+
+/* Called by the helpers on template.h while recording. */
+void template_record(int type, const void *p, const void *src, size_t len)
+{
+  struct template_op *op;
+
+  if ((op = add_op(type, p, len)) != NULL)
+    op->src = src ? src - packet : 0;
+}
+
+/* A checksum with the pseudo header of 'ip' (see t_cksum_psd()). */
+void template_record_psd(int type, const void *field, const void *data, size_t len, const void *ip)
+{
+  struct template_op *op;
+
+  if ((op = add_op(type, field, len)) != NULL)
+  {
+    op->src = data - packet;
+    op->psd = ip - packet;
+  }
+}
+
+/* Records a bit field. 'mask' is a copy of the structure 's' with only
+   the field bits set. */
+void template_record_bits(const void *s, const void *mask, size_t size)
+{
+  const uint8_t *m = mask;
+  struct template_op *op;
+  size_t i;
+
+  for (i = 0; i < size && m[i] == 0; i++);
+  assert(i < size);
+
+  /* NOTE: 'src' holds the mask and 'len' the shift. */
+  if ((op = add_op(TOP_BITS, s + i, __builtin_ctz(m[i]))) != NULL)
+    op->src = m[i];
+}
+
+/* Appends an operation to the template being recorded. */
+static struct template_op *add_op(int type, const void *p, size_t len)
+{
+  struct template *t = template_rec->t;
+  struct template_op *op;
+
+  if (t->nops == t->max_ops)
+  {
+    void *q;
+
+    t->max_ops = t->max_ops ? 2 * t->max_ops : 32;
+    if ((q = realloc(t->ops, t->max_ops * sizeof(struct template_op))) == NULL)
+    {
+      ERROR("Error allocating template");
+      exit(EXIT_FAILURE);
+    }
+    t->ops = q;
+  }
+
+  /* FIX: Offsets are 16 bits wide. Bigger packets are built the old way. */
+  if ((size_t)(p - packet) + len > UINT16_MAX)
+  {
+    template_rec->invalid = 1;
+    return NULL;
+  }
+
+  op = &t->ops[t->nops++];
+  op->type   = type;
+  op->offset = p - packet;
+  op->src    = 0;
+  op->len    = len;
+  op->psd    = 0;
+  return op;
+}
+
+/* Builds the next packet of module 'index' on the packet buffer.
+   The first packet is rendered by the module itself and becomes the template.
+   Modules which don't support templates are always called. */
+int template_build(unsigned index, const struct config_options * const __restrict__ co, size_t *size)
+{
+  struct template_slot *slot = &slots[index];
+  const struct template *t;
+  uint32_t key = 0;
+  unsigned variant = 0;
+
+  switch (slot->state)
+  {
+    case TEMPLATE_NEW:
+      return render(slot, index, co, size, FALSE, 0);
+
+    case TEMPLATE_UNSUPPORTED:
+      last_template = NULL;
+      mod_table[index].func(co, size);
+      return FALSE;
+  }
+
+  /* NOTE: The key is the first draw of the module, as on the full build. */
+  if (slot->key_fn != NULL)
+  {
+    key = RANDOM();
+    variant = slot->key_fn(key);
+
+    /* Layout not seen yet: render it with this key. */
+    if (!slot->ready[variant])
+      return render(slot, index, co, size, TRUE, key);
+  }
+
+  t = &slot->variants[variant];
+
+  if (t != last_template)
+  {
+    alloc_packet(t->size);
+    memcpy(packet, t->bytes, t->size);
+    last_template = t;
+  }
+
+  apply(t, co, key);
+  *size = t->size;
+  return TRUE;
+}
+
+/* Frees the templates of the calling thread. */
+void template_free(void)
+{
+  unsigned i, j;
+
+  for (i = 0; i < MAXIMUM_MODULES; i++)
+  {
+    for (j = 0; j < TEMPLATE_MAX_VARIANTS; j++)
+      release(&slots[i].variants[j]);
+    memset(&slots[i], 0, sizeof(struct template_slot));
+  }
+
+  last_template = NULL;
+}
+
+/* Calls the module, recording its template. */
+static int render(struct template_slot *slot,
+                  unsigned index,
+                  const struct config_options * const __restrict__ co,
+                  size_t *size,
+                  int forced,
+                  uint32_t key)
+{
+  struct template t = {};
+  struct template_rec rec = { .t = &t, .forced = forced, .key = key };
+  unsigned variant = 0;
+
+  template_rec = &rec;
+  mod_table[index].func(co, size);
+  template_rec = NULL;
+
+  last_template = NULL;
+
+  if (rec.key_fn != NULL)
+  {
+    variant = rec.key_fn(rec.key);
+    assert(variant < TEMPLATE_MAX_VARIANTS);
+  }
+
+  /* FIX: A module must have the same layouts always. */
+  if (!rec.supported || rec.invalid || (forced && rec.key_fn == NULL))
+  {
+    release(&t);
+    slot->state = TEMPLATE_UNSUPPORTED;
+    return FALSE;
+  }
+
+  if ((t.bytes = malloc(*size)) == NULL)
+  {
+    ERROR("Error allocating template");
+    exit(EXIT_FAILURE);
+  }
+  memcpy(t.bytes, packet, *size);
+  t.size = *size;
+
+  prune(&t);
+
+  slot->key_fn = rec.key_fn;
+  slot->variants[variant] = t;
+  slot->ready[variant] = TRUE;
+  slot->state = TEMPLATE_READY;
+
+  last_template = &slot->variants[variant];
+  return TRUE;
+}
+
+/* Makes the next packet from the template already on the packet buffer. */
+static void apply(const struct template *t, const struct config_options * const __restrict__ co, uint32_t key)
+{
+  const struct template_op *op, *end = t->ops + t->nops;
+  void *p = packet;
+
+  for (op = t->ops; op < end; op++)
+  {
+    void *dst = p + op->offset;
+
+    switch (op->type)
+    {
+      case TOP_RND8:    *(uint8_t *)dst   = RANDOM(); break;
+      case TOP_RND16:   *(uint16_t *)dst  = htons(RANDOM()); break;
+      case TOP_RND32:   *(uint32_t *)dst  = htonl(RANDOM()); break;
+      case TOP_RND24:   *(uint32_t *)dst  = htonl(RANDOM() << 8); break;
+      case TOP_RAW16:   *(uint16_t *)dst  = RANDOM(); break;
+      case TOP_RAW32:   *(uint32_t *)dst  = RANDOM(); break;
+      case TOP_NETMASK: *(in_addr_t *)dst = NETMASK_RND(0); break;
+      case TOP_SADDR:   *(in_addr_t *)dst = INADDR_RND(co->ip.saddr); break;
+      case TOP_DADDR:   *(in_addr_t *)dst = co->ip.daddr; break;
+      case TOP_SPORT:   *(uint16_t *)dst  = htons(IPPORT_RND(co->source)); break;
+      case TOP_DPORT:   *(uint16_t *)dst  = htons(IPPORT_RND(co->dest)); break;
+      case TOP_KEY8:    *(uint8_t *)dst   = key; break;
+
+      case TOP_BITS:
+        *(uint8_t *)dst = (*(uint8_t *)dst & ~op->src) | ((RANDOM() << op->len) & op->src);
+        break;
+      case TOP_COPY:    memcpy(dst, p + op->src, op->len); break;
+
+      case TOP_BYTES:   random_fill(dst, op->len); break;
+
+      case TOP_CKSUM:
+        *(uint16_t *)dst = 0;
+        *(uint16_t *)dst = cksum(p + op->src, op->len);
+        break;
+
+      /* NOTE: Summed again on every packet, pseudo header included. No
+               RFC 1624 update here: the addresses and most L4 fields are
+               new on each packet, and updating them one by one is slower. */
+      case TOP_CKSUM_PSD:
+        {
+          const struct iphdr *ip = p + op->psd;
+
+          *(uint16_t *)dst = 0;
+          *(uint16_t *)dst = cksum_fold(cksum_add(p + op->src, op->len,
+                               cksum_pseudo(ip->saddr, ip->daddr, ip->protocol, op->len)));
+        }
+        break;
+
+      case TOP_PSEUDO:
+        {
+          const struct iphdr *ip = p + op->psd;
+
+          *(uint16_t *)dst = ~cksum_fold(cksum_pseudo(ip->saddr, ip->daddr, ip->protocol, op->len));
+        }
+        break;
+    }
+  }
+}
+
+/* Drops checksums over constant bytes only: the template already has them right.
+   NOTE: A checksum kept changes its own field, which may be covered by another one. */
+static void prune(struct template *t)
+{
+  unsigned i, n = 0;
+
+  for (i = 0; i < t->nops; i++)
+  {
+    struct template_op *op = &t->ops[i];
+
+    if (op->type == TOP_CKSUM || op->type == TOP_CKSUM_PSD || op->type == TOP_PSEUDO ||
+        op->type == TOP_COPY)
+    {
+      unsigned j;
+      int variable = FALSE;
+
+      /* Any kept operation writing inside the covered bytes (or the addresses
+         of the pseudo header)? */
+      for (j = 0; j < n && !variable; j++)
+      {
+        const struct template_op *w = &t->ops[j];
+
+        if (op->type != TOP_PSEUDO &&
+            w->offset < op->src + op->len && op->src < w->offset + op_width(w))
+          variable = TRUE;
+
+        if ((op->type == TOP_CKSUM_PSD || op->type == TOP_PSEUDO) &&
+            w->offset < op->psd + sizeof(struct iphdr) && op->psd + 12U < w->offset + op_width(w))
+          variable = TRUE;
+      }
+
+      if (!variable)
+        continue;
+    }
+
+    t->ops[n++] = *op;
+  }
+
+  t->nops = n;
+}
+
+/* Bytes written by an operation. */
+static unsigned op_width(const struct template_op *op)
+{
+  switch (op->type)
+  {
+    case TOP_CKSUM:
+    case TOP_CKSUM_PSD:
+    case TOP_PSEUDO:    return 2;
+    case TOP_BITS:      return 1;
+  }
+
+  return op->len;
+}
+
+static void release(struct template *t)
+{
+  free(t->bytes);
+  free(t->ops);
+  memset(t, 0, sizeof(struct template));
+}
@@ -0,0 +1,351 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* io_uring output: packets are queued as IORING_OP_SENDMSG on the raw socket
+   and submitted once per batch. Completions are reaped as they come, so a
+   failed send is only counted (by errno), it doesn't stop the worker.
+   With --sqpoll a kernel thread does the submissions: the worker keeps
+   building packets while the previous batch is being sent. */
+
+#include <common.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+/* Minimum number of submission queue entries. */
+#define URING_ENTRIES       64
+
+/* SQPOLL thread idle time before it sleeps (ms). */
+#define URING_SQ_IDLE       1000
+
+/* One packet in flight. Owned by the kernel from submission to completion. */
+struct uring_slot {
+  void *buffer;               /* private copy of the packet  */
+  size_t size;                /* allocated buffer size       */
+  struct sockaddr_in sin;     /* destination address         */
+  struct iovec iov;
+  struct msghdr msg;
+};
+
+/* NOTE: All the state below is private to each worker thread. */
+static __thread socket_t fd = -1;           /* raw socket                     */
+static __thread int ring_fd = -1;
+static __thread void *sq_map = NULL, *cq_map = NULL;
+static __thread size_t sq_map_size, cq_map_size;
+static __thread struct io_uring_sqe *sqes = NULL;
+static __thread size_t sqes_size;
+static __thread uint32_t *sq_head, *sq_tail, *sq_flags, *sq_array, sq_mask;
+static __thread uint32_t *cq_head, *cq_tail, cq_mask;
+static __thread struct io_uring_cqe *cqes;
+static __thread uint32_t tail;              /* our submission queue tail      */
+static __thread struct uring_slot *slots = NULL;
+static __thread unsigned *free_slots = NULL;
+static __thread unsigned free_nr, slots_nr;
+static __thread unsigned queued;            /* filled, not published yet      */
+static __thread unsigned inflight;          /* published, not completed       */
+static __thread unsigned batch;
+static __thread int sqpoll;
+
+static int  submit(unsigned);
+static void reap(void);
+
+static inline int io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+  return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static inline int io_uring_enter(int ring, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+  return syscall(__NR_io_uring_enter, ring, to_submit, min_complete, flags, NULL, 0);
+}
+
+static inline int io_uring_register(int ring, unsigned opcode, void *arg, unsigned nr_args)
+{
+  return syscall(__NR_io_uring_register, ring, opcode, arg, nr_args);
+}
+
+/* Creates the raw socket, the ring and the packet slots. */
+int uringOpen(const struct config_options * const __restrict__ co, unsigned id)
+{
+  struct io_uring_params p = {};
+  unsigned entries, i;
+
+  UNUSED_PARAM(id);
+
+  if ((fd = openRawSocket()) == -1)
+    return FALSE;
+
+  batch = co->batch;
+  sqpoll = co->sqpoll;
+
+  /* Room for the batch being filled and the one being sent. */
+  for (entries = URING_ENTRIES; entries < 2 * batch; entries <<= 1);
+
+  if (sqpoll)
+  {
+    p.flags = IORING_SETUP_SQPOLL;
+    p.sq_thread_idle = URING_SQ_IDLE;
+  }
+
+  if ((ring_fd = io_uring_setup(entries, &p)) == -1)
+  {
+    perror("error setting up io_uring");
+    return FALSE;
+  }
+
+  /* NOTE: Since 5.4 both rings share one mapping, but two maps work too. */
+  sq_map_size = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+  cq_map_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+
+  if ((sq_map = mmap(NULL, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ring_fd, IORING_OFF_SQ_RING)) == MAP_FAILED ||
+      (cq_map = mmap(NULL, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ring_fd, IORING_OFF_CQ_RING)) == MAP_FAILED ||
+      (sqes = mmap(NULL, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ring_fd, IORING_OFF_SQES)) == MAP_FAILED)
+  {
+    perror("error mapping io_uring");
+    return FALSE;
+  }
+
+  sq_head  = sq_map + p.sq_off.head;
+  sq_tail  = sq_map + p.sq_off.tail;
+  sq_flags = sq_map + p.sq_off.flags;
+  sq_array = sq_map + p.sq_off.array;
+  sq_mask  = *(uint32_t *)(sq_map + p.sq_off.ring_mask);
+  cq_head  = cq_map + p.cq_off.head;
+  cq_tail  = cq_map + p.cq_off.tail;
+  cq_mask  = *(uint32_t *)(cq_map + p.cq_off.ring_mask);
+  cqes     = cq_map + p.cq_off.cqes;
+  tail     = *sq_tail;
+
+  /* The socket is registered: no file lookup for each send. */
+  if (io_uring_register(ring_fd, IORING_REGISTER_FILES, &fd, 1) == -1)
+  {
+    perror("error registering socket on io_uring");
+    return FALSE;
+  }
+
+  /* NOTE: One slot per queue entry, so a free slot always has a free entry. */
+  slots_nr = p.sq_entries;
+  slots = calloc(slots_nr, sizeof(struct uring_slot));
+  free_slots = malloc(slots_nr * sizeof(unsigned));
+  if (slots == NULL || free_slots == NULL)
+  {
+    ERROR("Error allocating io_uring slots");
+    return FALSE;
+  }
+
+  /* Each message points to its own iovec and destination, for good. */
+  for (i = 0; i < slots_nr; i++)
+  {
+    slots[i].msg.msg_name    = &slots[i].sin;
+    slots[i].msg.msg_namelen = sizeof(struct sockaddr_in);
+    slots[i].msg.msg_iov     = &slots[i].iov;
+    slots[i].msg.msg_iovlen  = 1;
+    free_slots[i] = slots_nr - 1 - i;
+  }
+  free_nr = slots_nr;
+  queued = inflight = 0;
+
+  return TRUE;
+}
+
+void uringClose(void)
+{
+  if (slots != NULL)
+  {
+    unsigned i;
+
+    for (i = 0; i < slots_nr; i++)
+      free(slots[i].buffer);
+  }
+
+  free(slots);
+  free(free_slots);
+  slots = NULL;
+  free_slots = NULL;
+
+  if (sqes != NULL && sqes != MAP_FAILED)
+    munmap(sqes, sqes_size);
+  if (cq_map != NULL && cq_map != MAP_FAILED)
+    munmap(cq_map, cq_map_size);
+  if (sq_map != NULL && sq_map != MAP_FAILED)
+    munmap(sq_map, sq_map_size);
+  sqes = NULL;
+  cq_map = sq_map = NULL;
+
+  if (ring_fd != -1)
+  {
+    close(ring_fd);
+    ring_fd = -1;
+  }
+
+  if (fd != -1)
+  {
+    close(fd);
+    fd = -1;
+  }
+}
+
+/* Queues a copy of the packet. The batch is submitted when full. */
+int uringSend(const void * const buffer, size_t size, const struct config_options * const __restrict__ co)
+{
+  struct uring_slot *slot;
+  struct io_uring_sqe *sqe;
+  unsigned n;
+
+  assert(buffer != NULL);
+  assert(size > 0);
+  assert(co != NULL);
+
+  /* All slots in flight: waits for at least one. */
+  while (free_nr == 0)
+    if (!submit(1))
+      return FALSE;
+
+  n = free_slots[--free_nr];
+  slot = &slots[n];
+
+  /* Grows slot buffer, if necessary. Since packet sizes don't vary much,
+     this happens only in the first few packets. */
+  if (size > slot->size)
+  {
+    void *p;
+
+    if ((p = realloc(slot->buffer, size)) == NULL)
+    {
+      ERROR("Error reallocating io_uring slot buffer");
+      return FALSE;
+    }
+
+    slot->buffer = p;
+    slot->size = size;
+  }
+
+  memcpy(slot->buffer, buffer, size);
+  slot->iov.iov_base = slot->buffer;
+  slot->iov.iov_len = size;
+  slot->sin.sin_family = AF_INET;
+  slot->sin.sin_port = htons(IPPORT_RND(co->dest));
+  slot->sin.sin_addr.s_addr = co->ip.daddr;
+
+  sqe = &sqes[tail & sq_mask];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_SENDMSG;
+  sqe->flags = IOSQE_FIXED_FILE;
+  sqe->fd = 0;                          /* index on the registered files */
+  sqe->addr = (uintptr_t)&slot->msg;
+  sqe->len = 1;
+  sqe->msg_flags = MSG_NOSIGNAL;
+  sqe->user_data = n;
+  sq_array[tail & sq_mask] = tail & sq_mask;
+  tail++;
+
+  if (++queued >= batch)
+    return submit(0);
+
+  return TRUE;
+}
+
+/* Submits what is queued and waits for every completion. */
+int uringFlush(void)
+{
+  while (queued || inflight)
+    if (!submit(inflight + queued))
+      return FALSE;
+
+  return TRUE;
+}
+
+/* Submits the queued entries, waiting for 'wait' completions (at most
+   the ones in flight), and reaps whatever is complete. */
+static int submit(unsigned wait)
+{
+  unsigned flags = 0, to_submit = 0;
+  int r;
+
+  if (queued)
+  {
+    __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+    inflight += queued;
+    queued = 0;
+  }
+
+  if (wait > inflight)
+    wait = inflight;
+  if (wait)
+    flags |= IORING_ENTER_GETEVENTS;
+
+  /* NOTE: The SQPOLL thread takes the entries by itself. The worker only
+           enters the kernel to wake it up or to wait. */
+  if (sqpoll)
+  {
+    if (__atomic_load_n(sq_flags, __ATOMIC_ACQUIRE) & IORING_SQ_NEED_WAKEUP)
+      flags |= IORING_ENTER_SQ_WAKEUP;
+  }
+  else
+    to_submit = tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+
+  if (to_submit || flags)
+  {
+    do
+    {
+      r = io_uring_enter(ring_fd, to_submit, wait, flags);
+      syscalls_made++;
+    } while (r == -1 && errno == EINTR);
+
+    /* NOTE: On EAGAIN or EBUSY the entries stay on the queue, for the next call. */
+    if (r == -1 && errno != EAGAIN && errno != EBUSY)
+    {
+      perror("error submitting to io_uring");
+      return FALSE;
+    }
+  }
+
+  reap();
+  return TRUE;
+}
+
+/* Counts the completions and frees their slots. */
+static void reap(void)
+{
+  uint32_t head = *cq_head;
+  uint32_t end = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+
+  for (; head != end; head++)
+  {
+    struct io_uring_cqe *cqe = &cqes[head & cq_mask];
+
+    if (cqe->res < 0)
+      STATS_ERROR(-cqe->res);
+    else
+    {
+      packets_sent++;
+      STATS_ADD(packets, 1);
+      STATS_ADD(bytes, cqe->res);
+    }
+
+    free_slots[free_nr++] = cqe->user_data;
+    inflight--;
+  }
+
+  __atomic_store_n(cq_head, end, __ATOMIC_RELEASE);
+}
@@ -33,7 +33,7 @@ void usage(void)
 {
   show_version();
 
-  puts("\nUsage: t50 <host> [/CIDR] [options]");
+  puts("\nUsage: t50 <host> [/CIDR] | <start>-<end> [options]");
 
   general_help();
   gre_help();
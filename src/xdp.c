@@ -0,0 +1,444 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* AF_XDP output: each worker owns an XDP socket bound to one queue of the
+   interface (--queue plus the worker number), with its own UMEM. Frames are
+   written to UMEM chunks and posted on the tx ring; the chunks come back on
+   the completion ring once the driver is done with them.
+
+   NOTE: Only the tx side is used, so no XDP program is needed. The fill ring
+         exists only because the kernel won't bind without one. */
+
+#include <common.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <linux/if_xdp.h>
+
+/* UMEM chunk size. Frames can't be bigger than this. */
+#define XSK_FRAME_SIZE      4096
+
+/* Minimum tx and completion ring sizes (grown if --batch needs more). */
+#define XSK_RING_SIZE       2048
+
+/* Fill ring size (unused, but required). */
+#define XSK_FILL_SIZE       64
+
+/* Busy polling time, in microseconds (--busy-poll). */
+#define XSK_BUSY_POLL       20
+
+/* Maximum number of tries to wait for free chunks or completions. */
+#define MAX_KICK_TRIES      100
+
+/* A tx or completion ring, mapped from the socket. */
+struct xsk_ring {
+  uint32_t *producer;
+  uint32_t *consumer;
+  uint32_t *flags;
+  void *desc;
+  uint32_t mask;
+  void *map;
+  size_t map_size;
+};
+
+/* NOTE: All the state below is private to each worker thread. */
+static __thread socket_t fd = -1;
+static __thread void *umem = NULL;
+static __thread size_t umem_size;
+static __thread struct xsk_ring tx, cq;
+static __thread uint64_t *free_chunks = NULL; /* chunks we can write to     */
+static __thread unsigned free_nr;
+static __thread uint16_t *chunk_len = NULL;   /* bytes on each chunk        */
+static __thread uint32_t tx_head;             /* our tx ring producer       */
+static __thread unsigned pending;             /* posted, not published yet  */
+static __thread unsigned outstanding;         /* published, not completed   */
+static __thread unsigned batch;
+static __thread int zerocopy;
+static __thread int busy_poll;
+static __thread struct ethhdr eth;            /* prebuilt Ethernet header   */
+
+static int  createXsk(int, unsigned, unsigned, int);
+static int  mapRing(struct xsk_ring *, const struct xdp_ring_offset *, off_t, unsigned, size_t);
+static void unmapRing(struct xsk_ring *);
+static int  kick(void);
+static void reclaim(void);
+
+/* Creates the worker XDP socket, on queue --queue + worker number. */
+int xdpOpen(const struct config_options * const __restrict__ co, unsigned id)
+{
+  int ifindex, type, mtu, r;
+  unsigned ring_size;
+
+  if (!getInterfaceInfo(co->interface, &ifindex, &type, &mtu, eth.h_source))
+    return FALSE;
+
+  batch = co->batch;
+  busy_poll = co->busy_poll;
+
+  for (ring_size = XSK_RING_SIZE; ring_size < 2 * batch; ring_size <<= 1);
+
+  /* Zero copy when the driver has it, unless --xdp-copy. */
+  zerocopy = !co->xdp_copy;
+  if ((r = createXsk(ifindex, co->queue + id, ring_size, zerocopy)) == 0)
+  {
+    xdpClose();
+    zerocopy = FALSE;
+    r = createXsk(ifindex, co->queue + id, ring_size, FALSE);
+  }
+
+  if (r <= 0)
+    return FALSE;
+
+  memcpy(eth.h_dest, co->dst_mac, ETH_ALEN);
+  eth.h_proto = htons(ETH_P_IP);
+
+  printf("Worker %u: %s queue %u (%s mode)\n",
+         id, co->interface, co->queue + id, zerocopy ? "zero copy" : "copy");
+
+  return TRUE;
+}
+
+void xdpClose(void)
+{
+  unmapRing(&tx);
+  unmapRing(&cq);
+
+  if (fd != -1)
+  {
+    close(fd);
+    fd = -1;
+  }
+
+  if (umem != NULL)
+  {
+    munmap(umem, umem_size);
+    umem = NULL;
+  }
+
+  free(free_chunks);
+  free(chunk_len);
+  free_chunks = NULL;
+  chunk_len = NULL;
+}
+
+/* Copies the packet to a free UMEM chunk and posts it on the tx ring.
+   The ring is published (and the kernel woken up) every 'batch' frames. */
+int xdpSend(const void * const buffer, size_t size, const struct config_options * const __restrict__ co)
+{
+  struct xdp_desc *desc;
+  void *data;
+  uint64_t addr;
+  int tries;
+
+  UNUSED_PARAM(co);
+
+  assert(buffer != NULL);
+  assert(size > 0);
+
+  if (ETH_HLEN + size > XSK_FRAME_SIZE)
+  {
+    STATS_ERROR(EMSGSIZE);
+    ERROR("Packet is bigger than the XDP frame size.");
+    return FALSE;
+  }
+
+  /* Needs a free chunk and a free tx ring slot. */
+  for (tries = MAX_KICK_TRIES;
+       free_nr == 0 || tx_head - __atomic_load_n(tx.consumer, __ATOMIC_ACQUIRE) > tx.mask; )
+  {
+    struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+
+    if (!kick())
+      return FALSE;
+
+    if (free_nr != 0 && tx_head - __atomic_load_n(tx.consumer, __ATOMIC_ACQUIRE) <= tx.mask)
+      break;
+
+    if (!tries--)
+    {
+      ERROR("Error waiting for a free XDP frame.");
+      return FALSE;
+    }
+
+    poll(&pfd, 1, 10);
+    syscalls_made++;
+  }
+
+  addr = free_chunks[--free_nr];
+  data = umem + addr;
+  memcpy(data, &eth, ETH_HLEN);
+  memcpy(data + ETH_HLEN, buffer, size);
+
+  ip_fill_checksum(data + ETH_HLEN, size);
+
+  desc = (struct xdp_desc *)tx.desc + (tx_head++ & tx.mask);
+  desc->addr = addr;
+  desc->len = ETH_HLEN + size;
+  desc->options = 0;
+  chunk_len[addr / XSK_FRAME_SIZE] = size;
+
+  if (++pending >= batch)
+    return kick();
+
+  return TRUE;
+}
+
+/* Publishes what is still posted and waits for every frame to complete. */
+int xdpFlush(void)
+{
+  int tries;
+
+  for (tries = MAX_KICK_TRIES; outstanding || pending; )
+  {
+    struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+    unsigned before = outstanding + pending;
+
+    if (!kick())
+      return FALSE;
+
+    if (!outstanding)
+      break;
+
+    /* Only gives up if nothing completes for a while. */
+    if (outstanding < before)
+      tries = MAX_KICK_TRIES;
+    else if (!tries--)
+    {
+      ERROR("Error waiting for XDP completions.");
+      return FALSE;
+    }
+
+    poll(&pfd, 1, 10);
+    syscalls_made++;
+  }
+
+  return TRUE;
+}
+
+/* Publishes the posted frames, wakes the kernel if it asks for it and
+   takes back the completed chunks.
+   NOTE: On copy mode the frames are sent by the sendto() itself, a few
+         dozen at a time, so it is called until the tx ring drains. */
+static int kick(void)
+{
+  int tries;
+
+  if (pending)
+  {
+    __atomic_store_n(tx.producer, tx_head, __ATOMIC_RELEASE);
+    outstanding += pending;
+    pending = 0;
+  }
+
+  for (tries = MAX_KICK_TRIES; tries--; )
+  {
+    if (__atomic_load_n(tx.consumer, __ATOMIC_ACQUIRE) == tx_head)
+      break;
+
+    if (zerocopy && !busy_poll && !(__atomic_load_n(tx.flags, __ATOMIC_ACQUIRE) & XDP_RING_NEED_WAKEUP))
+      break;
+
+    syscalls_made++;
+    if (sendto(fd, NULL, 0, MSG_DONTWAIT, NULL, 0) != -1)
+    {
+      if (zerocopy)
+        break;
+      continue;
+    }
+
+    /* NOTE: EAGAIN means there is more to send (or the device queue is full).
+             EBUSY and ENOBUFS mean one frame was dropped. */
+    if (errno != EAGAIN && errno != EINTR)
+      STATS_ERROR(errno);
+
+    if (errno != EAGAIN && errno != EINTR && errno != EBUSY && errno != ENOBUFS && errno != ENETDOWN)
+    {
+      perror("error sending XDP frames");
+      return FALSE;
+    }
+  }
+
+  reclaim();
+  return TRUE;
+}
+
+/* Takes back the chunks on the completion ring. */
+static void reclaim(void)
+{
+  uint32_t head = *cq.consumer;
+  uint32_t tail = __atomic_load_n(cq.producer, __ATOMIC_ACQUIRE);
+  uint64_t bytes = 0;
+  unsigned n = tail - head;
+
+  if (n == 0)
+    return;
+
+  for (; head != tail; head++)
+  {
+    uint64_t addr = ((uint64_t *)cq.desc)[head & cq.mask];
+
+    bytes += chunk_len[addr / XSK_FRAME_SIZE];
+    free_chunks[free_nr++] = addr;
+  }
+
+  __atomic_store_n(cq.consumer, tail, __ATOMIC_RELEASE);
+
+  outstanding -= n;
+  packets_sent += n;
+  STATS_ADD(packets, n);
+  STATS_ADD(bytes, bytes);
+}
+
+/* Creates the socket, its UMEM and rings, and binds it to the queue.
+   Returns 1 on success, 0 if zero copy was asked for but the driver doesn't
+   have it, -1 on errors. */
+static int createXsk(int ifindex, unsigned queue, unsigned ring_size, int zc)
+{
+  struct xdp_umem_reg reg = {};
+  struct xdp_mmap_offsets off;
+  struct sockaddr_xdp sxdp = {};
+  socklen_t len = sizeof(off);
+  unsigned chunks, n, i;
+
+  if ((fd = socket(AF_XDP, SOCK_RAW, 0)) == -1)
+  {
+    perror("error opening XDP socket");
+    return -1;
+  }
+
+  /* Twice as many chunks as ring slots: the ring can be full while the
+     completions of the previous round are still coming back. */
+  chunks = 2 * ring_size;
+  umem_size = (size_t)chunks * XSK_FRAME_SIZE;
+  if ((umem = mmap(NULL, umem_size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0)) == MAP_FAILED)
+  {
+    umem = NULL;
+    perror("error allocating UMEM");
+    return -1;
+  }
+
+  free_chunks = malloc(chunks * sizeof(uint64_t));
+  chunk_len = calloc(chunks, sizeof(uint16_t));
+  if (free_chunks == NULL || chunk_len == NULL)
+  {
+    ERROR("Error allocating UMEM chunk list");
+    return -1;
+  }
+
+  for (i = 0; i < chunks; i++)
+    free_chunks[i] = (uint64_t)i * XSK_FRAME_SIZE;
+  free_nr = chunks;
+
+  reg.addr = (uintptr_t)umem;
+  reg.len = umem_size;
+  reg.chunk_size = XSK_FRAME_SIZE;
+  if (setsockopt(fd, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) == -1)
+  {
+    perror("error registering UMEM");
+    return -1;
+  }
+
+  n = XSK_FILL_SIZE;
+  if (setsockopt(fd, SOL_XDP, XDP_UMEM_FILL_RING, &n, sizeof(n)) == -1 ||
+      setsockopt(fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &ring_size, sizeof(ring_size)) == -1 ||
+      setsockopt(fd, SOL_XDP, XDP_TX_RING, &ring_size, sizeof(ring_size)) == -1)
+  {
+    perror("error setting XDP rings");
+    return -1;
+  }
+
+  if (getsockopt(fd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &len) == -1)
+  {
+    perror("error getting XDP ring offsets");
+    return -1;
+  }
+
+  if (!mapRing(&tx, &off.tx, XDP_PGOFF_TX_RING, ring_size, sizeof(struct xdp_desc)) ||
+      !mapRing(&cq, &off.cr, XDP_UMEM_PGOFF_COMPLETION_RING, ring_size, sizeof(uint64_t)))
+    return -1;
+
+#if defined(SO_PREFER_BUSY_POLL) && defined(SO_BUSY_POLL_BUDGET)
+  if (busy_poll)
+  {
+    int prefer = 1, usecs = XSK_BUSY_POLL, budget = batch;
+
+    if (setsockopt(fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &prefer, sizeof(prefer)) == -1 ||
+        setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usecs, sizeof(usecs)) == -1 ||
+        setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL_BUDGET, &budget, sizeof(budget)) == -1)
+    {
+      perror("error setting busy polling");
+      return -1;
+    }
+  }
+#else
+  /* NOTE: Built on headers older than Linux 5.11. */
+  if (busy_poll)
+  {
+    ERROR("--busy-poll is not supported by this build");
+    return -1;
+  }
+#endif
+
+  sxdp.sxdp_family = AF_XDP;
+  sxdp.sxdp_ifindex = ifindex;
+  sxdp.sxdp_queue_id = queue;
+  sxdp.sxdp_flags = XDP_USE_NEED_WAKEUP | (zc ? XDP_ZEROCOPY : XDP_COPY);
+  if (bind(fd, (struct sockaddr *)&sxdp, sizeof(sxdp)) == -1)
+  {
+    if (zc && errno == EOPNOTSUPP)
+      return 0;
+
+    perror("error binding XDP socket (check --queue)");
+    return -1;
+  }
+
+  tx_head = *tx.producer;
+  pending = outstanding = 0;
+
+  return 1;
+}
+
+static int mapRing(struct xsk_ring *r, const struct xdp_ring_offset *o, off_t pgoff, unsigned size, size_t entry)
+{
+  r->map_size = o->desc + size * entry;
+  if ((r->map = mmap(NULL, r->map_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd, pgoff)) == MAP_FAILED)
+  {
+    r->map = NULL;
+    perror("error mapping XDP ring");
+    return FALSE;
+  }
+
+  r->producer = r->map + o->producer;
+  r->consumer = r->map + o->consumer;
+  r->flags    = r->map + o->flags;
+  r->desc     = r->map + o->desc;
+  r->mask     = size - 1;
+
+  return TRUE;
+}
+
+static void unmapRing(struct xsk_ring *r)
+{
+  if (r->map != NULL)
+  {
+    munmap(r->map, r->map_size);
+    r->map = NULL;
+  }
+}
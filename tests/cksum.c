@@ -0,0 +1,305 @@
+/*
+ *  T50 - Experimental Mixed Packet Injector
+ *
+ *  Copyright (C) 2010 - 2014 - T50 developers
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Differential test and microbenchmark of the Internet checksum
+   implementations on cksum.c (built in, to reach the static ones).
+
+   Every implementation the CPU has (scalar, SSE2, AVX2) and cksum(), as
+   dispatched by cksum_init(), are checked against a plain RFC 1071 loop,
+   for every length up to CHECK_MAX_LENGTH, at every alignment up to 63
+   bytes, on random bytes and on all ones (the most carries). Partial sums
+   (cksum_add() over two pieces) are checked too, and so are checksums
+   updated by cksum_update() (RFC 1624) when a 16 or 32 bit field changes,
+   at every even and odd offset.
+
+   'make check' runs the test; 'make bench' (or 'cksum -b') times each
+   implementation on 20 to 9000 bytes. */
+
+#include "../src/cksum.c"
+
+/* Jumbo frames. */
+#define CHECK_MAX_LENGTH    9000
+
+/* Alignments checked: every offset within a cache line. */
+#define CHECK_ALIGNMENTS    64
+
+/* Length of the buffer updated field by field (odd: a padded last byte). */
+#define UPDATE_LENGTH       61
+
+/* Time spent on each benchmark point (ns). */
+#define BENCH_TIME_NS       100000000ULL
+
+struct impl {
+  const char *name;
+  uint64_t (*add)(const void *, size_t, uint64_t);
+};
+
+static struct impl impls[4];
+static unsigned nimpls;
+
+static uint8_t buffer[CHECK_MAX_LENGTH + CHECK_ALIGNMENTS] __attribute__((aligned(64)));
+
+/* cksum() itself, with the dispatch and the small size cut. */
+static uint64_t cksum_dispatched(const void *data, size_t length, uint64_t sum)
+{
+  return cksum_add(data, length, sum);
+}
+
+/* Folds a 32 bit sum of 16 bit words and complements it (RFC 1071). */
+static uint16_t reference_fold(uint32_t sum)
+{
+  while (sum >> 16)
+    sum = (sum & 0xffff) + (sum >> 16);
+
+  return ~sum;
+}
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void fill(int pattern)
+{
+  uint64_t x = 0x9e3779b97f4a7c15ULL;
+  size_t i;
+
+  for (i = 0; i < sizeof(buffer); i++)
+  {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    buffer[i] = pattern ? 0xff : (uint8_t)x;
+  }
+}
+
+/* Every implementation, every length and alignment. The reference sum
+   grows a byte at a time, so it costs nothing per length. */
+static unsigned check(void)
+{
+  unsigned errors = 0, pattern, align, i;
+  size_t n;
+
+  for (pattern = 0; pattern < 2; pattern++)
+  {
+    fill(pattern);
+
+    for (align = 0; align < CHECK_ALIGNMENTS; align++)
+    {
+      const uint8_t *p = buffer + align;
+      uint32_t even = 0;                    /* sum of the whole words so far */
+
+      for (n = 0; n <= CHECK_MAX_LENGTH; n++)
+      {
+        uint32_t sum = even;
+        uint16_t w = 0, expected;
+
+        /* NOTE: The odd byte is padded with a zero byte after it. */
+        if (n & 1)
+        {
+          memcpy(&w, p + n - 1, 1);
+          sum += w;
+        }
+        expected = reference_fold(sum);
+
+        for (i = 0; i < nimpls; i++)
+        {
+          uint16_t got = cksum_fold(impls[i].add(p, n, 0));
+
+          if (got != expected && errors++ < 20)
+            fprintf(stderr, "FAIL %-7s length %zu align %u %s: 0x%04x, expected 0x%04x\n",
+                    impls[i].name, n, align, pattern ? "ones" : "random", got, expected);
+        }
+
+        /* Two pieces (the first even) give the sum of the whole. */
+        if (n >= 2)
+        {
+          size_t k = (n / 2 * 7919) % n & ~(size_t)1;
+          uint16_t got = cksum_fold(cksum_add(p + k, n - k, cksum_add(p, k, 0)));
+
+          if (got != expected && errors++ < 20)
+            fprintf(stderr, "FAIL partial  length %zu align %u split %zu: 0x%04x, expected 0x%04x\n",
+                    n, align, k, got, expected);
+        }
+
+        if (n & 1)
+        {
+          memcpy(&w, p + n - 1, 2);
+          even += w;
+        }
+      }
+    }
+  }
+
+  return errors;
+}
+
+/* Sum of the whole words holding 'size' bytes at 'off' (the last one
+   padded, as by cksum(), past the end of the data). */
+static uint64_t field_sum(const uint8_t *p, size_t len, size_t off, size_t size)
+{
+  size_t start = off & ~(size_t)1, end = (off + size + 1) & ~(size_t)1;
+
+  return cksum_add(p + start, (end < len ? end : len) - start, 0);
+}
+
+/* Every field of 2 and 4 bytes, at every offset, goes through random
+   values, 0x00 and 0xff bytes and, when word aligned, the value giving a
+   checksum of 0x0000. Each change is checked by updating the checksum of
+   the previous one against summing it all again. On all zero data the
+   update gives 0x0000, not 0xffff: both are zero in one's complement
+   (RFC 1624, section 3), and real headers are never all zeros. */
+static unsigned check_update(void)
+{
+  static const size_t sizes[] = { 2, 4 };
+  uint8_t p[UPDATE_LENGTH];
+  uint64_t x = 0x2545f4914f6cdd1dULL;
+  unsigned errors = 0, data, step, j;
+  size_t off;
+
+  for (data = 0; data < 2; data++)
+    for (j = 0; j < 2; j++)
+      for (off = 0; off + sizes[j] <= UPDATE_LENGTH; off++)
+      {
+        size_t size = sizes[j], i;
+
+        for (i = 0; i < UPDATE_LENGTH; i++)
+        {
+          x ^= x << 13;
+          x ^= x >> 7;
+          x ^= x << 17;
+          p[i] = data ? (uint8_t)x : 0;
+        }
+
+        for (step = 0; step < 8; step++)
+        {
+          uint16_t check = cksum(p, UPDATE_LENGTH), expected, got, w;
+          uint64_t old_sum = field_sum(p, UPDATE_LENGTH, off, size);
+          int zeros = 1;
+
+          switch (step)
+          {
+            case 1: case 5: memset(p + off, 0x00, size); break;
+            case 2: case 6: memset(p + off, 0xff, size); break;
+            case 3:
+              if (!(off & 1))
+              {
+                /* NOTE: The word completing the sum to 0xffff. */
+                memset(p + off, 0, size);
+                w = cksum(p, UPDATE_LENGTH);
+                memcpy(p + off, &w, 2);
+                break;
+              }
+              /* fall through */
+            default:
+              for (i = 0; i < size; i++)
+              {
+                x ^= x << 13;
+                x ^= x >> 7;
+                x ^= x << 17;
+                p[off + i] = x;
+              }
+          }
+
+          got = cksum_update(check, old_sum, field_sum(p, UPDATE_LENGTH, off, size));
+          expected = cksum(p, UPDATE_LENGTH);
+
+          for (i = 0; i < UPDATE_LENGTH; i++)
+            zeros &= p[i] == 0;
+
+          if (got != expected && !(zeros && got == 0x0000 && expected == 0xffff) && errors++ < 20)
+            fprintf(stderr, "FAIL update   field %zu offset %zu step %u %s: 0x%04x, expected 0x%04x\n",
+                    size, off, step, data ? "random" : "zeros", got, expected);
+        }
+      }
+
+  return errors;
+}
+
+static void bench(void)
+{
+  static const size_t sizes[] = { 20, 40, 64, 128, 256, 576, 1024, 1500, 4096, 9000 };
+  volatile uint64_t sink = 0;
+  unsigned i, j;
+
+  fill(0);
+
+  printf("%6s", "bytes");
+  for (i = 0; i < nimpls; i++)
+    printf(" %17s", impls[i].name);
+  printf("\n%6s", "");
+  for (i = 0; i < nimpls; i++)
+    printf(" %8s %8s", "ns", "GB/s");
+  printf("\n");
+
+  for (j = 0; j < sizeof(sizes) / sizeof(sizes[0]); j++)
+  {
+    printf("%6zu", sizes[j]);
+
+    for (i = 0; i < nimpls; i++)
+    {
+      uint64_t start = now_ns(), elapsed, calls = 0;
+      unsigned k;
+
+      do
+      {
+        for (k = 0; k < 1000; k++)
+          sink += impls[i].add(buffer, sizes[j], sink & 1);
+        calls += k;
+      } while ((elapsed = now_ns() - start) < BENCH_TIME_NS);
+
+      printf(" %8.1f %8.2f", (double)elapsed / calls, (double)sizes[j] * calls / elapsed);
+    }
+
+    printf("\n");
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned errors;
+
+  cksum_init();
+
+  impls[nimpls++] = (struct impl){ "scalar", cksum_add_scalar };
+#if defined(__x86_64__) || defined(__i386__)
+  if (__builtin_cpu_supports("sse2"))
+    impls[nimpls++] = (struct impl){ "sse2", cksum_add_sse2 };
+  if (__builtin_cpu_supports("avx2"))
+    impls[nimpls++] = (struct impl){ "avx2", cksum_add_avx2 };
+#endif
+  impls[nimpls++] = (struct impl){ "cksum", cksum_dispatched };
+
+  if (argc > 1 && strcmp(argv[1], "-b") == 0)
+  {
+    bench();
+    return EXIT_SUCCESS;
+  }
+
+  errors = check();
+  errors += check_update();
+
+  printf("cksum: %u implementations, lengths 0-%u, %u alignments, updates: %s\n",
+         nimpls, CHECK_MAX_LENGTH, CHECK_ALIGNMENTS, errors ? "FAILED" : "ok");
+
+  return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}